@@ -0,0 +1,132 @@
+#include "BoardSnapshot.h"
+#include "HexMap.h"
+#include "HexCell.h"
+#include "HexMath.h"
+#include "MapEntity.h"
+
+FBoardSnapshot FBoardSnapshot::Capture(const AHexMap* Map, const TArray<AMapEntity*>& MapEntities)
+{
+    FBoardSnapshot Snapshot;
+    if (!Map)
+    {
+        return Snapshot;
+    }
+
+    Snapshot.Width = Map->GetMapWidth();
+    Snapshot.Height = Map->GetMapHeight();
+    Snapshot.Terrain = MakeShared<TArray<uint8>>(Map->GetCellFlags());
+    Snapshot.Occupancy.Init(INDEX_NONE, Snapshot.Width * Snapshot.Height);
+    Snapshot.Entities.Reserve(MapEntities.Num());
+
+    //Entity indices always match MapEntities, entities off the map are kept as dead placeholders
+    for (const AMapEntity* MapEntity : MapEntities)
+    {
+        FEntity Entity;
+        Entity.Coord = FHexMapCoord(-1, -1);
+        Entity.Health = 0;
+        Entity.MoveDistance = 0;
+        Entity.AttackDistance = 0;
+        Entity.IsFriendly = false;
+        Entity.IsHighValue = false;
+
+        const AHexCell* Cell = MapEntity ? MapEntity->GetMapCell() : nullptr;
+        if (Cell && Cell->GetOwningMap() == Map)
+        {
+            Entity.Coord = Cell->GetMapCoord();
+            Entity.Health = MapEntity->GetHealth();
+            Entity.MoveDistance = MapEntity->GetMoveDistance();
+            Entity.AttackDistance = MapEntity->GetAttackDistance();
+            Entity.IsFriendly = MapEntity->GetIsFriendly();
+            Entity.IsHighValue = MapEntity->GetIsHighValue();
+
+            if (Entity.IsAlive())
+            {
+                Snapshot.Occupancy[Snapshot.GetIndex(Entity.Coord)] = Snapshot.Entities.Num();
+            }
+        }
+        Snapshot.Entities.Add(Entity);
+    }
+
+    return Snapshot;
+}
+
+bool FBoardSnapshot::MoveEntity(int EntityIndex, const FHexMapCoord& To)
+{
+    FEntity& Entity = Entities[EntityIndex];
+    if (Entity.Coord == To)
+    {
+        return true;
+    }
+    if (!Entity.IsAlive() || !IsTraversable(To))
+    {
+        return false;
+    }
+    Occupancy[GetIndex(Entity.Coord)] = INDEX_NONE;
+    Occupancy[GetIndex(To)] = EntityIndex;
+    Entity.Coord = To;
+    return true;
+}
+
+FBoardSnapshot::FAttackResult FBoardSnapshot::TraceAttack(int EntityIndex, int Direction) const
+{
+    FAttackResult Result;
+    const FEntity& Entity = Entities[EntityIndex];
+
+    FHexAxial AttackCoord = HexMath::OffsetToAxial(Entity.Coord);
+    for (int i = 0; i < Entity.AttackDistance; i++)
+    {
+        AttackCoord = HexMath::Neighbor(AttackCoord, Direction);
+        FHexMapCoord Coord = HexMath::AxialToOffset(AttackCoord);
+        if (!IsValid(Coord))
+        {
+            break;
+        }
+        if ((GetCellFlags(Coord) & EHexCellFlags::Exists) == 0)
+        {
+            continue; //Holes in the map don't stop attacks, matching GetAttacks
+        }
+        if (!IsTerrainTraversable(Coord))
+        {
+            break;
+        }
+        Result.NumLocations++;
+        int Occupant = Occupancy[GetIndex(Coord)];
+        if (Occupant != INDEX_NONE)
+        {
+            Result.HitEntity = Occupant;
+            break;
+        }
+    }
+    return Result;
+}
+
+void FBoardSnapshot::DamageEntity(int EntityIndex, int Damage)
+{
+    FEntity& Entity = Entities[EntityIndex];
+    if (Entity.IsAlive())
+    {
+        Entity.Health = FMath::Max(0, Entity.Health - Damage);
+        if (!Entity.IsAlive())
+        {
+            Occupancy[GetIndex(Entity.Coord)] = INDEX_NONE;
+        }
+    }
+}
+
+float FBoardSnapshot::GetDistanceToTarget(const FHexMapCoord& Coord) const
+{
+    float MinDistance = FLT_MAX;
+    for (const auto& Entity : Entities)
+    {
+        if (Entity.IsFriendly && Entity.IsAlive())
+        {
+            float Distance = HexMath::Distance(Coord, Entity.Coord);
+            if (Entity.IsHighValue)
+            {
+                Distance *= 0.5f;
+            }
+            MinDistance = FMath::Min(MinDistance, Distance);
+        }
+    }
+    return MinDistance;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Util.h"
+
+class AHexMap;
+class AMapEntity;
+
+/**
+ * Actor free copy of the board, just terrain, occupancy and entity health. Cheap to copy for simulation,
+ * terrain never changes while simulating so copies share one capture of it and only copy occupancy and entities
+ */
+struct LD45_API FBoardSnapshot
+{
+public:
+
+    struct FEntity
+    {
+        FHexMapCoord Coord;
+        int16 Health;
+        int8 MoveDistance;
+        int8 AttackDistance;
+        bool IsFriendly;
+        bool IsHighValue;
+
+        FORCEINLINE bool IsAlive() const { return Health > 0; }
+    };
+
+    struct FAttackResult
+    {
+        int HitEntity = INDEX_NONE;
+        int NumLocations = 0;
+    };
+
+    //Entity indices match MapEntities
+    static FBoardSnapshot Capture(const AHexMap* Map, const TArray<AMapEntity*>& MapEntities);
+
+    FORCEINLINE bool IsValid(const FHexMapCoord& Coord) const { return Coord.IsValid(Width, Height); }
+
+    FORCEINLINE int GetIndex(const FHexMapCoord& Coord) const { return Coord.x + Coord.y * Width; }
+
+    //Terrain flags as captured, occupancy lives in Occupancy
+    FORCEINLINE uint8 GetCellFlags(const FHexMapCoord& Coord) const { return (*Terrain)[GetIndex(Coord)]; }
+
+    FORCEINLINE bool IsTerrainTraversable(const FHexMapCoord& Coord) const
+    {
+        return IsValid(Coord) && (GetCellFlags(Coord) & (EHexCellFlags::Exists | EHexCellFlags::Traversable)) == (EHexCellFlags::Exists | EHexCellFlags::Traversable);
+    }
+
+    FORCEINLINE int GetOccupant(const FHexMapCoord& Coord) const { return IsValid(Coord) ? Occupancy[GetIndex(Coord)] : INDEX_NONE; }
+
+    FORCEINLINE bool IsTraversable(const FHexMapCoord& Coord) const { return IsTerrainTraversable(Coord) && Occupancy[GetIndex(Coord)] == INDEX_NONE; }
+
+    bool MoveEntity(int EntityIndex, const FHexMapCoord& To);
+
+    //Same ray as AMapEntity::GetAttacks, stops at the first occupied or unattackable cell
+    FAttackResult TraceAttack(int EntityIndex, int Direction) const;
+
+    void DamageEntity(int EntityIndex, int Damage);
+
+    //Hex distance to the closest living friendly, high value targets count as half as far
+    float GetDistanceToTarget(const FHexMapCoord& Coord) const;
+
+public:
+
+    int Width = 0;
+    int Height = 0;
+
+    TSharedPtr<const TArray<uint8>> Terrain;
+    TArray<int16> Occupancy;
+    TArray<FEntity> Entities;
+};
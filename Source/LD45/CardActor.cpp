@@ -3,11 +3,21 @@
 
 #include "CardActor.h"
 #include "Components/WidgetComponent.h"
+#include "Engine/World.h"
+#include "CardDefinition.h"
+#include "HexCell.h"
+#include "VoidGameMode.h"
 
 ACardActor::ACardActor(const FObjectInitializer& ObjectInitializer)
     : Super(ObjectInitializer)
 {
     CardWidgetComponent = CreateDefaultSubobject<UWidgetComponent>(TEXT("CardWidget"));
+
+    Definition = nullptr;
+    SourceCell = nullptr;
+    PlacementMap = nullptr;
+    ValidityMaskSourceCell = nullptr;
+    PlacementHighlightChannel = EHexHighlightChannel::Movement;
 }
 
 void ACardActor::BeginPlay()
@@ -18,12 +28,28 @@ void ACardActor::BeginPlay()
 
 bool ACardActor::CanInteractWithCell_Implementation(AHexCell* Cell) const
 {
+    return Cell && CanEffectsTarget(MakeEffectContext(Cell));
+}
+
+bool ACardActor::CanEffectsTarget(const FCardEffectContext& Context) const
+{
+    if (HasNativeEffects())
+    {
+        for (const UCardEffect* Effect : Definition->Effects)
+        {
+            if (Effect && !Effect->CanTarget(Context))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
     return false;
 }
 
 void ACardActor::StartHoverCell(AHexCell* Cell)
 {
-    OnStartHoverCell.Broadcast(Cell);
+    OnStartHoverCell.Broadcast(Cell, IsValidTargetCell(Cell));
 }
 
 void ACardActor::EndHoverCell(AHexCell* Cell)
@@ -33,11 +59,116 @@ void ACardActor::EndHoverCell(AHexCell* Cell)
 
 bool ACardActor::TryInteract(AHexCell* Cell)
 {
-    if (CanInteractWithCell(Cell))
+    bool CanInteract = PlacementMap ? IsValidTargetCell(Cell) : CanInteractWithCell(Cell);
+    if (CanInteract)
     {
+        if (HasNativeEffects())
+        {
+            auto VoidGameMode = Cast<AVoidGameMode>(GetWorld()->GetAuthGameMode());
+            if (!VoidGameMode || !VoidGameMode->ExecuteCardEffects(Definition->Effects, MakeEffectContext(Cell)))
+            {
+                return false;
+            }
+        }
         OnInteract.Broadcast(Cell);
         return true;
     }
     return false;
 }
 
+bool ACardActor::HasNativeEffects() const
+{
+    return Definition && Definition->Effects.Num() > 0;
+}
+
+FCardEffectContext ACardActor::MakeEffectContext(AHexCell* Cell) const
+{
+    return MakeEffectContext(Cell ? Cell->GetOwningMap() : nullptr, Cell ? Cell->GetMapCoord() : FHexMapCoord());
+}
+
+FCardEffectContext ACardActor::MakeEffectContext(AHexMap* Map, const FHexMapCoord& Target) const
+{
+    FCardEffectContext Context;
+    Context.Map = Map;
+    Context.Target = Target;
+    if (SourceCell)
+    {
+        Context.Source = SourceCell->GetMapCoord();
+        Context.HasSource = true;
+    }
+    return Context;
+}
+
+void ACardActor::BeginPlacement(AHexMap* Map)
+{
+    EndPlacement();
+    PlacementMap = Map;
+    UpdateValidityMask();
+}
+
+void ACardActor::EndPlacement()
+{
+    if (PlacementMap && IsPlacementHighlighted)
+    {
+        PlacementMap->ClearHighlightChannel(PlacementHighlightChannel);
+    }
+    PlacementMap = nullptr;
+    ValidityMaskSourceCell = nullptr;
+    ValidityMask.Empty();
+    IsPlacementHighlighted = false;
+    ValidityMaskVersion = INDEX_NONE;
+}
+
+bool ACardActor::IsValidTargetCell(AHexCell* Cell)
+{
+    if (!Cell || !PlacementMap || Cell->GetOwningMap() != PlacementMap)
+    {
+        return Cell && CanInteractWithCell(Cell);
+    }
+
+    UpdateValidityMask();
+
+    int Index = PlacementMap->GetCellIndex(Cell->GetMapCoord());
+    return ValidityMask.IsValidIndex(Index) && ValidityMask[Index];
+}
+
+void ACardActor::UpdatePlacementHighlight(FColor Color)
+{
+    if (PlacementMap)
+    {
+        UpdateValidityMask();
+        PlacementMap->SetHighlightMask(PlacementHighlightChannel, ValidityMask, Color);
+        IsPlacementHighlighted = true;
+    }
+}
+
+void ACardActor::UpdateValidityMask()
+{
+    if (!PlacementMap)
+    {
+        return;
+    }
+
+    if (ValidityMaskVersion == PlacementMap->GetBoardVersion() && ValidityMaskSourceCell == SourceCell)
+    {
+        return;
+    }
+
+    //Walks coords rather than cell actors, with chunked cells the actors of streamed out chunks are null.
+    //Those are evaluated on the native effects so the mask is still right once they stream in
+    const auto& Cells = PlacementMap->GetCells();
+    ValidityMask.Init(false, Cells.Num());
+    for (int y = 0; y < PlacementMap->GetMapHeight(); y++)
+    {
+        for (int x = 0; x < PlacementMap->GetMapWidth(); x++)
+        {
+            const FHexMapCoord Coord(x, y);
+            const int Index = PlacementMap->GetCellIndex(Coord);
+            AHexCell* Cell = Cells[Index];
+            ValidityMask[Index] = Cell ? CanInteractWithCell(Cell) : CanEffectsTarget(MakeEffectContext(PlacementMap, Coord));
+        }
+    }
+
+    ValidityMaskVersion = PlacementMap->GetBoardVersion();
+    ValidityMaskSourceCell = SourceCell;
+}
@@ -4,12 +4,16 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "CardEffect.h"
+#include "HexMap.h"
 #include "CardActor.generated.h"
 
 class UWidgetComponent;
 class AHexCell;
+class UCardDefinition;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FCardCellEvent, AHexCell*, Cell);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FCardHoverEvent, AHexCell*, Cell, bool, IsValidTarget);
 
 UCLASS()
 class LD45_API ACardActor : public AActor
@@ -24,6 +28,7 @@ public:
     UFUNCTION(BlueprintNativeEvent, BlueprintCallable)
     bool CanInteractWithCell(AHexCell* Cell) const;
 
+    //Broadcasts with the cell's validity, a bit test against the mask while placing
     UFUNCTION(BlueprintCallable)
     void StartHoverCell(AHexCell* Cell);
 
@@ -33,10 +38,38 @@ public:
     UFUNCTION(BlueprintCallable)
     bool TryInteract(AHexCell* Cell);
 
+    UFUNCTION(BlueprintCallable)
+    bool HasNativeEffects() const;
+
+    //Evaluates CanInteractWithCell over the whole board, call when the card is picked up
+    UFUNCTION(BlueprintCallable)
+    void BeginPlacement(AHexMap* Map);
+
+    UFUNCTION(BlueprintCallable)
+    void EndPlacement();
+
+    //Bit test against the cached validity mask, rebuilt only if the board has changed
+    UFUNCTION(BlueprintCallable)
+    bool IsValidTargetCell(AHexCell* Cell);
+
+    //Highlights valid cells on PlacementHighlightChannel, only cells whose validity changed are touched
+    UFUNCTION(BlueprintCallable)
+    void UpdatePlacementHighlight(FColor Color);
+
+protected:
+
+    FCardEffectContext MakeEffectContext(AHexCell* Cell) const;
+    FCardEffectContext MakeEffectContext(AHexMap* Map, const FHexMapCoord& Target) const;
+
+    //Native effects only, works on coords whose cell is streamed out
+    bool CanEffectsTarget(const FCardEffectContext& Context) const;
+
+    void UpdateValidityMask();
+
 public:
 
     UPROPERTY(BlueprintAssignable)
-    FCardCellEvent OnStartHoverCell;
+    FCardHoverEvent OnStartHoverCell;
 
     UPROPERTY(BlueprintAssignable)
     FCardCellEvent OnEndHoverCell;
@@ -44,11 +77,33 @@ public:
     UPROPERTY(BlueprintAssignable)
     FCardCellEvent OnInteract;
 
+    UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = true))
+    UCardDefinition* Definition;
+
+    //First cell picked by two step cards, e.g. the entity a move card acts on
+    UPROPERTY(BlueprintReadWrite)
+    AHexCell* SourceCell;
+
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly)
+    EHexHighlightChannel PlacementHighlightChannel;
+
 protected:
 
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
     UWidgetComponent* CardWidgetComponent;
 
+private:
+
+    UPROPERTY(Transient)
+    AHexMap* PlacementMap;
+
+    UPROPERTY(Transient)
+    AHexCell* ValidityMaskSourceCell;
+
+    TBitArray<> ValidityMask;
+    bool IsPlacementHighlighted = false;
+    int ValidityMaskVersion = INDEX_NONE;
+
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
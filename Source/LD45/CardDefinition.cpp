@@ -0,0 +1,15 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CardDefinition.h"
+#include "CardWidget.h"
+#include "CardActor.h"
+#include "CardEffect.h"
+
+const FName UCardDefinition::PrimaryAssetType = TEXT("CardDefinition");
+const FName UCardDefinition::PresentationBundle = TEXT("Presentation");
+
+FPrimaryAssetId UCardDefinition::GetPrimaryAssetId() const
+{
+    return FPrimaryAssetId(PrimaryAssetType, GetFName());
+}
@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "CardDefinition.generated.h"
+
+class UCardWidget;
+class ACardActor;
+class UCardEffect;
+
+UENUM(BlueprintType)
+enum class ECardType : uint8
+{
+    Unit,
+    Action
+};
+
+/**
+ * Gameplay definition of a card, presentation is soft referenced and streamed in by the asset manager
+ */
+UCLASS(BlueprintType)
+class LD45_API UCardDefinition : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+    static const FName PrimaryAssetType;
+    static const FName PresentationBundle;
+
+    FPrimaryAssetId GetPrimaryAssetId() const override;
+
+    UFUNCTION(BlueprintCallable)
+    bool GetIsUnitCard() const { return CardType == ECardType::Unit; }
+
+public:
+
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly)
+    int Cost = 1;
+
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly)
+    ECardType CardType = ECardType::Action;
+
+    //Actor spawned when the card is played, implements the card's effect
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly)
+    TSubclassOf<ACardActor> CardActorClass;
+
+    //Native effects applied as one batch when the card is played, on top of anything CardActorClass does
+    UPROPERTY(EditDefaultsOnly, Instanced, BlueprintReadOnly)
+    TArray<UCardEffect*> Effects;
+
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta = (AssetBundles = "Presentation"))
+    TSoftClassPtr<UCardWidget> WidgetClass;
+};
@@ -0,0 +1,133 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CardEffect.h"
+#include "HexMap.h"
+#include "HexCell.h"
+#include "MapEntity.h"
+#include "HexMath.h"
+#include "HexCoordSet.h"
+
+namespace
+{
+    AMapEntity* GetEntityAt(const AHexMap* Map, const FHexMapCoord& Coord)
+    {
+        if (AHexCell* Cell = Map ? Map->GetCell(Coord.x, Coord.y) : nullptr)
+        {
+            return Cell->GetOccupyingEntity();
+        }
+        return nullptr;
+    }
+}
+
+bool UCardEffect_Spawn::CanTarget(const FCardEffectContext& Context) const
+{
+    if (Context.Map && EntityClass)
+    {
+        if (RequirePlayerSpawnLocation)
+        {
+            return Context.Map->IsPlayerSpawnLocation(Context.Target) && Context.Map->IsTraversable(Context.Target);
+        }
+        return Context.Map->IsTraversable(Context.Target);
+    }
+    return false;
+}
+
+void UCardEffect_Spawn::Compile(const FCardEffectContext& Context, FBoardCommandList& OutCommands) const
+{
+    FBoardCommand Command;
+    Command.Type = EBoardCommandType::Spawn;
+    Command.Target = Context.Target;
+    Command.EntityClass = EntityClass;
+    OutCommands.Add(Command);
+}
+
+bool UCardEffect_DamageArea::CanTarget(const FCardEffectContext& Context) const
+{
+    TArray<FHexMapCoord, TInlineAllocator<64>> Hits;
+    GatherHits(Context, Hits);
+    return Hits.Num() > 0;
+}
+
+void UCardEffect_DamageArea::Compile(const FCardEffectContext& Context, FBoardCommandList& OutCommands) const
+{
+    TArray<FHexMapCoord, TInlineAllocator<64>> Hits;
+    GatherHits(Context, Hits);
+    for (const auto& Coord : Hits)
+    {
+        FBoardCommand Command;
+        Command.Type = EBoardCommandType::Damage;
+        Command.Target = Coord;
+        Command.Amount = Damage;
+        OutCommands.Add(Command);
+    }
+}
+
+void UCardEffect_DamageArea::GatherHits(const FCardEffectContext& Context, TArray<FHexMapCoord, TInlineAllocator<64>>& OutHits) const
+{
+    if (!Context.Map)
+    {
+        return;
+    }
+
+    //Flags rather than the cell actor, which is null while its chunk is streamed out
+    const int Width = Context.Map->GetMapWidth();
+    const int Height = Context.Map->GetMapHeight();
+    if (!Context.Target.IsValid(Width, Height) || !(Context.Map->GetCellFlags()[Context.Map->GetCellIndex(Context.Target)] & EHexCellFlags::Exists))
+    {
+        return;
+    }
+
+    for (FHexSpiralIterator It(HexMath::OffsetToAxial(Context.Target), Radius); It; ++It)
+    {
+        FHexMapCoord Coord = HexMath::AxialToOffset(*It);
+        if (Coord.IsValid(Width, Height))
+        {
+            AMapEntity* Entity = GetEntityAt(Context.Map, Coord);
+            if (Entity && (DamageFriendlies || !Entity->GetIsFriendly()))
+            {
+                OutHits.Add(Coord);
+            }
+        }
+    }
+}
+
+bool UCardEffect_Move::CanTarget(const FCardEffectContext& Context) const
+{
+    if (Context.HasSource)
+    {
+        AMapEntity* Entity = GetEntityAt(Context.Map, Context.Source);
+        if (Entity && Entity->GetIsFriendly())
+        {
+            //A move range is a few dozen cells, hashed rather than a board sized bitset
+            FHexCoordSet MoveLocations;
+            Entity->GatherMoveLocations(MoveLocations);
+            return MoveLocations.Contains(Context.Target);
+        }
+    }
+    return false;
+}
+
+void UCardEffect_Move::Compile(const FCardEffectContext& Context, FBoardCommandList& OutCommands) const
+{
+    FBoardCommand Command;
+    Command.Type = EBoardCommandType::Move;
+    Command.Target = Context.Source;
+    Command.Destination = Context.Target;
+    OutCommands.Add(Command);
+}
+
+bool UCardEffect_Buff::CanTarget(const FCardEffectContext& Context) const
+{
+    AMapEntity* Entity = GetEntityAt(Context.Map, Context.Target);
+    return Entity && Entity->GetIsFriendly();
+}
+
+void UCardEffect_Buff::Compile(const FCardEffectContext& Context, FBoardCommandList& OutCommands) const
+{
+    FBoardCommand Command;
+    Command.Type = EBoardCommandType::Buff;
+    Command.Target = Context.Target;
+    Command.Amount = HealthAmount;
+    OutCommands.Add(Command);
+}
@@ -0,0 +1,145 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Util.h"
+#include "CardEffect.generated.h"
+
+class AHexMap;
+class AMapEntity;
+
+enum class EBoardCommandType : uint8
+{
+    Spawn,
+    Damage,
+    Move,
+    Buff
+};
+
+/**
+ * Single board mutation produced by compiling card effects
+ */
+struct FBoardCommand
+{
+    EBoardCommandType Type = EBoardCommandType::Damage;
+    FHexMapCoord Target;
+    FHexMapCoord Destination; //Move only
+    int Amount = 0;
+    TSubclassOf<AMapEntity> EntityClass; //Spawn only
+};
+
+typedef TArray<FBoardCommand, TInlineAllocator<16>> FBoardCommandList;
+
+USTRUCT(BlueprintType)
+struct FCardEffectContext
+{
+    GENERATED_BODY()
+
+public:
+
+    UPROPERTY(BlueprintReadWrite)
+    AHexMap* Map = nullptr;
+
+    //Cell the card was played on
+    UPROPERTY(BlueprintReadWrite)
+    FHexMapCoord Target;
+
+    //Previously selected cell for two step cards, e.g. the entity to move
+    UPROPERTY(BlueprintReadWrite)
+    FHexMapCoord Source;
+
+    UPROPERTY(BlueprintReadWrite)
+    bool HasSource = false;
+};
+
+/**
+ * Native card effect, compiled into board commands rather than mutating the map directly
+ */
+UCLASS(Abstract, EditInlineNew, DefaultToInstanced, BlueprintType)
+class LD45_API UCardEffect : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+    virtual bool CanTarget(const FCardEffectContext& Context) const { return true; }
+
+    virtual void Compile(const FCardEffectContext& Context, FBoardCommandList& OutCommands) const {}
+};
+
+UCLASS(meta = (DisplayName = "Spawn"))
+class LD45_API UCardEffect_Spawn : public UCardEffect
+{
+	GENERATED_BODY()
+
+public:
+
+    bool CanTarget(const FCardEffectContext& Context) const override;
+    void Compile(const FCardEffectContext& Context, FBoardCommandList& OutCommands) const override;
+
+public:
+
+    UPROPERTY(EditAnywhere)
+    TSubclassOf<AMapEntity> EntityClass;
+
+    UPROPERTY(EditAnywhere)
+    bool RequirePlayerSpawnLocation = true;
+};
+
+UCLASS(meta = (DisplayName = "Damage Area"))
+class LD45_API UCardEffect_DamageArea : public UCardEffect
+{
+	GENERATED_BODY()
+
+public:
+
+    //Only where the area would hit someone, so a played card always has something to apply
+    bool CanTarget(const FCardEffectContext& Context) const override;
+    void Compile(const FCardEffectContext& Context, FBoardCommandList& OutCommands) const override;
+
+private:
+
+    //Cells in the area holding an entity the card damages
+    void GatherHits(const FCardEffectContext& Context, TArray<FHexMapCoord, TInlineAllocator<64>>& OutHits) const;
+
+public:
+
+    UPROPERTY(EditAnywhere)
+    int Damage = 1;
+
+    //0 only hits the target cell
+    UPROPERTY(EditAnywhere)
+    int Radius = 0;
+
+    UPROPERTY(EditAnywhere)
+    bool DamageFriendlies = false;
+};
+
+UCLASS(meta = (DisplayName = "Move"))
+class LD45_API UCardEffect_Move : public UCardEffect
+{
+	GENERATED_BODY()
+
+public:
+
+    bool CanTarget(const FCardEffectContext& Context) const override;
+    void Compile(const FCardEffectContext& Context, FBoardCommandList& OutCommands) const override;
+};
+
+UCLASS(meta = (DisplayName = "Buff"))
+class LD45_API UCardEffect_Buff : public UCardEffect
+{
+	GENERATED_BODY()
+
+public:
+
+    bool CanTarget(const FCardEffectContext& Context) const override;
+    void Compile(const FCardEffectContext& Context, FBoardCommandList& OutCommands) const override;
+
+public:
+
+    UPROPERTY(EditAnywhere)
+    int HealthAmount = 1;
+};
@@ -2,6 +2,57 @@
 
 
 #include "CardWidget.h"
+#include "CardDefinition.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCardWidget, Log, All)
+
+FCardData FCardData::FromClass(TSubclassOf<UCardWidget> Class)
+{
+    FCardData Data;
+    if (Class)
+    {
+        //Read from the CDO so we don't need to construct the widget tree
+        const UCardWidget* Defaults = GetDefault<UCardWidget>(Class);
+        Data.CardClass = Class;
+        Data.Cost = Defaults->Cost;
+        Data.IsUnitCard = Defaults->IsUnitCard;
+    }
+    return Data;
+}
+
+FCardData FCardData::FromDefinition(UCardDefinition* Definition)
+{
+    FCardData Data;
+    if (Definition)
+    {
+        Data.Definition = Definition;
+        Data.CardClass = Definition->WidgetClass.Get();
+        Data.Cost = Definition->Cost;
+        Data.IsUnitCard = Definition->GetIsUnitCard();
+    }
+    return Data;
+}
+
+TSubclassOf<UCardWidget> FCardData::GetWidgetClass() const
+{
+    if (CardClass || !Definition)
+    {
+        return CardClass;
+    }
+    if (UClass* LoadedClass = Definition->WidgetClass.Get())
+    {
+        return LoadedClass;
+    }
+    UE_LOG(LogCardWidget, Warning, TEXT("Presentation for %s not streamed in yet, loading synchronously"), *GetNameSafe(Definition));
+    return Definition->WidgetClass.LoadSynchronous();
+}
+
+void UCardWidget::InitCard(const FCardData& Data)
+{
+    CardData = Data;
+    Cost = Data.Cost;
+    IsUnitCard = Data.IsUnitCard;
+}
 
 void UCardWidget::Drawn_Implementation()
 {
@@ -11,4 +62,4 @@ void UCardWidget::Drawn_Implementation()
 void UCardWidget::Discarded_Implementation()
 {
 
-}
\ No newline at end of file
+}
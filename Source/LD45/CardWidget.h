@@ -6,6 +6,42 @@
 #include "Blueprint/UserWidget.h"
 #include "CardWidget.generated.h"
 
+class UCardWidget;
+class UCardDefinition;
+
+/**
+ * Identity and gameplay data of a card, independent of any widget presenting it
+ */
+USTRUCT(BlueprintType)
+struct LD45_API FCardData
+{
+    GENERATED_BODY()
+
+public:
+
+    FCardData() {}
+
+    static FCardData FromClass(TSubclassOf<UCardWidget> Class);
+    static FCardData FromDefinition(UCardDefinition* Definition);
+
+    bool IsValid() const { return Definition != nullptr || CardClass != nullptr; }
+
+    //Resolves the widget class, definitions only have it once their presentation bundle is loaded
+    TSubclassOf<UCardWidget> GetWidgetClass() const;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly)
+    UCardDefinition* Definition = nullptr;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly)
+    TSubclassOf<UCardWidget> CardClass;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly)
+    int Cost = 1;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly)
+    bool IsUnitCard = false;
+};
+
 /**
  * 
  */
@@ -23,6 +59,16 @@ public:
     UFUNCTION(BlueprintNativeEvent)
     void Discarded();
 
+    UFUNCTION(BlueprintCallable)
+    const FCardData& GetCardData() const { return CardData; }
+
+protected:
+
+    friend class AGamePlayerController;
+
+    //Called when the widget is (re)assigned to a card, widgets are pooled so this may happen many times
+    void InitCard(const FCardData& Data);
+
 public:
 
     UPROPERTY(EditDefaultsOnly, BlueprintReadOnly)
@@ -30,4 +76,9 @@ public:
 
     UPROPERTY(EditDefaultsOnly, BlueprintReadOnly)
     bool IsUnitCard = false;
+
+protected:
+
+    UPROPERTY(Transient, BlueprintReadOnly)
+    FCardData CardData;
 };
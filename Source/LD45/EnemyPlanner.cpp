@@ -0,0 +1,239 @@
+#include "EnemyPlanner.h"
+#include "HexMath.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformTime.h"
+
+namespace
+{
+    const float HitFriendlyScore = 10.0f;
+    const float HitHighValueScore = 20.0f;
+    const float HitEnemyScore = -6.0f;
+    const float DistanceScore = -1.0f;
+
+    struct FPlannerState
+    {
+        FBoardSnapshot Board;
+        TArray<FPlannedEnemyAction, TInlineAllocator<8>> FirstTurn;
+        TArray<int, TInlineAllocator<8>> PendingAttacks; //Per entity, resolved at the start of the next turn
+        float Score = 0.0f;
+        float Rank = 0.0f;
+    };
+
+    //Telegraphed attacks hit whoever is standing there when they resolve, enemies included
+    void ResolvePendingAttacks(FPlannerState& State)
+    {
+        for (int EntityIndex = 0; EntityIndex < State.PendingAttacks.Num(); EntityIndex++)
+        {
+            int Direction = State.PendingAttacks[EntityIndex];
+            if (Direction != INDEX_NONE && State.Board.Entities[EntityIndex].IsAlive())
+            {
+                auto Attack = State.Board.TraceAttack(EntityIndex, Direction);
+                if (Attack.HitEntity != INDEX_NONE)
+                {
+                    const auto& Target = State.Board.Entities[Attack.HitEntity];
+                    State.Score += Target.IsFriendly ? (Target.IsHighValue ? HitHighValueScore : HitFriendlyScore) : HitEnemyScore;
+                    State.Board.DamageEntity(Attack.HitEntity, 1);
+                }
+            }
+            State.PendingAttacks[EntityIndex] = INDEX_NONE;
+        }
+    }
+
+    //Picks the telegraph for an enemy that has just moved, must hit a friendly like AITelegraphAttack
+    int ChooseAttack(const FBoardSnapshot& Board, int EntityIndex)
+    {
+        int BestDirection = INDEX_NONE;
+        for (int Direction = 0; Direction < 6; Direction++)
+        {
+            auto Attack = Board.TraceAttack(EntityIndex, Direction);
+            if (Attack.HitEntity != INDEX_NONE && Board.Entities[Attack.HitEntity].IsFriendly)
+            {
+                BestDirection = Direction;
+                if (Board.Entities[Attack.HitEntity].IsHighValue)
+                {
+                    break;
+                }
+            }
+        }
+        return BestDirection;
+    }
+
+    void GatherMoves(const FBoardSnapshot& Board, int EntityIndex, int MaxMoves, TArray<FHexMapCoord, TInlineAllocator<64>>& OutMoves)
+    {
+        const auto& Entity = Board.Entities[EntityIndex];
+
+        struct FCandidate
+        {
+            FHexMapCoord Coord;
+            float Distance;
+        };
+        TArray<FCandidate, TInlineAllocator<64>> Candidates;
+
+        for (FHexSpiralIterator It(HexMath::OffsetToAxial(Entity.Coord), Entity.MoveDistance); It; ++It)
+        {
+            FHexMapCoord Coord = HexMath::AxialToOffset(*It);
+            if (Board.IsTraversable(Coord))
+            {
+                Candidates.Add({ Coord, Board.GetDistanceToTarget(Coord) });
+            }
+        }
+
+        Candidates.Sort([](const FCandidate& A, const FCandidate& B) { return A.Distance < B.Distance; });
+
+        OutMoves.Reset();
+        for (int i = 0; i < Candidates.Num() && i < MaxMoves; i++)
+        {
+            OutMoves.Add(Candidates[i].Coord);
+        }
+        if (OutMoves.Num() == 0)
+        {
+            OutMoves.Add(Entity.Coord); //Boxed in, stay put
+        }
+    }
+
+    float EvaluatePosition(const FBoardSnapshot& Board)
+    {
+        float Score = 0.0f;
+        for (const auto& Entity : Board.Entities)
+        {
+            if (!Entity.IsFriendly && Entity.IsAlive())
+            {
+                float Distance = Board.GetDistanceToTarget(Entity.Coord);
+                if (Distance < FLT_MAX)
+                {
+                    Score += DistanceScore * Distance;
+                }
+            }
+        }
+        return Score;
+    }
+
+    void KeepBest(TArray<FPlannerState>& States, int BeamWidth)
+    {
+        //Position is scored on top of accumulated damage so beams favour enemies that close in
+        for (auto& State : States)
+        {
+            State.Rank = State.Score + EvaluatePosition(State.Board);
+        }
+        States.Sort([](const FPlannerState& A, const FPlannerState& B)
+        {
+            return A.Rank > B.Rank;
+        });
+        if (States.Num() > BeamWidth)
+        {
+            States.SetNum(BeamWidth, false);
+        }
+    }
+}
+
+FEnemyPlan FEnemyPlanner::Plan(const FBoardSnapshot& Board, const FEnemyPlannerSettings& Settings)
+{
+    FEnemyPlan Result;
+
+    TArray<int> Enemies;
+    for (int EntityIndex = 0; EntityIndex < Board.Entities.Num(); EntityIndex++)
+    {
+        if (!Board.Entities[EntityIndex].IsFriendly && Board.Entities[EntityIndex].IsAlive())
+        {
+            Enemies.Add(EntityIndex);
+        }
+    }
+    if (Enemies.Num() == 0)
+    {
+        return Result;
+    }
+
+    const double EndTime = FPlatformTime::Seconds() + Settings.TimeBudgetMs * 0.001;
+
+    TArray<FPlannerState> Beam;
+    {
+        FPlannerState& Root = Beam.AddDefaulted_GetRef();
+        Root.Board = Board;
+        Root.PendingAttacks.Init(INDEX_NONE, Board.Entities.Num());
+    }
+
+    TArray<FPlannerState> Best;
+    for (int Turn = 0; Turn < Settings.Depth; Turn++)
+    {
+        for (auto& State : Beam)
+        {
+            ResolvePendingAttacks(State);
+        }
+
+        bool IsOutOfTime = false;
+        for (int EnemyIndex : Enemies)
+        {
+            //Each state expands independently on the task graph workers
+            TArray<TArray<FPlannerState>> Children;
+            Children.SetNum(Beam.Num());
+
+            ParallelFor(Beam.Num(), [&](int32 StateIndex)
+            {
+                const FPlannerState& Parent = Beam[StateIndex];
+                if (!Parent.Board.Entities[EnemyIndex].IsAlive())
+                {
+                    Children[StateIndex].Add(Parent);
+                    return;
+                }
+
+                TArray<FHexMapCoord, TInlineAllocator<64>> Moves;
+                GatherMoves(Parent.Board, EnemyIndex, Settings.MaxMovesPerEnemy, Moves);
+
+                for (const auto& Move : Moves)
+                {
+                    FPlannerState& Child = Children[StateIndex].Add_GetRef(Parent);
+                    Child.Board.MoveEntity(EnemyIndex, Move);
+                    int Attack = ChooseAttack(Child.Board, EnemyIndex);
+                    Child.PendingAttacks[EnemyIndex] = Attack;
+                    if (Turn == 0)
+                    {
+                        Child.FirstTurn.Add({ EnemyIndex, Move, Attack });
+                    }
+                }
+            });
+
+            TArray<FPlannerState> NextBeam;
+            for (auto& StateChildren : Children)
+            {
+                Result.StatesEvaluated += StateChildren.Num();
+                NextBeam.Append(MoveTemp(StateChildren));
+            }
+            KeepBest(NextBeam, Settings.BeamWidth);
+            Beam = MoveTemp(NextBeam);
+
+            if (FPlatformTime::Seconds() > EndTime && Turn > 0)
+            {
+                IsOutOfTime = true;
+                break;
+            }
+        }
+
+        if (IsOutOfTime)
+        {
+            break; //Partial turns aren't comparable, keep the last complete one
+        }
+
+        Result.TurnsSearched = Turn + 1;
+        Best = Beam;
+
+        if (FPlatformTime::Seconds() > EndTime)
+        {
+            break;
+        }
+    }
+
+    //Account for attacks still telegraphed at the horizon
+    for (auto& State : Best)
+    {
+        ResolvePendingAttacks(State);
+    }
+    KeepBest(Best, 1);
+
+    if (Best.Num() > 0)
+    {
+        Result.Actions.Append(Best[0].FirstTurn.GetData(), Best[0].FirstTurn.Num());
+        Result.Score = Best[0].Score;
+        Result.IsValid = true;
+    }
+    return Result;
+}
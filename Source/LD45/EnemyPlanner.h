@@ -0,0 +1,44 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BoardSnapshot.h"
+
+struct FEnemyPlannerSettings
+{
+    //Enemy turns simulated ahead, friendlies are assumed to hold position
+    int Depth = 2;
+
+    //States kept after each enemy is expanded
+    int BeamWidth = 16;
+
+    //Closest move candidates considered per enemy per state
+    int MaxMovesPerEnemy = 8;
+
+    float TimeBudgetMs = 8.0f;
+};
+
+struct FPlannedEnemyAction
+{
+    int EntityIndex = INDEX_NONE;
+    FHexMapCoord Move;
+    int AttackDirection = INDEX_NONE;
+};
+
+struct FEnemyPlan
+{
+    TArray<FPlannedEnemyAction> Actions; //First turn only, in entity order
+    float Score = 0.0f;
+    int TurnsSearched = 0;
+    int StatesEvaluated = 0;
+    bool IsValid = false;
+};
+
+/**
+ * Beam search over joint enemy moves and telegraphed attacks on a board snapshot
+ */
+class LD45_API FEnemyPlanner
+{
+public:
+
+    static FEnemyPlan Plan(const FBoardSnapshot& Board, const FEnemyPlannerSettings& Settings);
+};
@@ -3,21 +3,88 @@
 
 #include "GamePlayerController.h"
 #include "CardWidget.h"
+#include "CardDefinition.h"
+#include "VoidGameMode.h"
+#include "GameStateSnapshot.h"
+#include "Engine/World.h"
+#include "Engine/AssetManager.h"
+#include "Components/PanelWidget.h"
 #include "Util.h"
 
+DEFINE_LOG_CATEGORY_STATIC(LogGamePlayerController, Log, All)
+
 void AGamePlayerController::BeginPlay()
 {
     Super::BeginPlay();
 
+    //Only card data lives in the deck, widgets are created as cards are drawn
+    DeckCards.Reserve(DeckDefinitions.Num() + Deck.Num());
+    for (auto Definition : DeckDefinitions)
+    {
+        FCardData CardData = FCardData::FromDefinition(Definition);
+        if (CardData.IsValid())
+        {
+            DeckCards.Add(CardData);
+        }
+    }
     for (auto CardClass : Deck)
     {
-        if (auto CardWidget = CreateWidget<UCardWidget>(this, CardClass))
+        FCardData CardData = FCardData::FromClass(CardClass);
+        if (CardData.IsValid())
+        {
+            DeckCards.Add(CardData);
+        }
+    }
+
+    ShuffleDeck();
+
+    StartDeckLoad();
+}
+
+void AGamePlayerController::StartDeckLoad()
+{
+    TArray<FPrimaryAssetId> AssetIds;
+    for (auto Definition : DeckDefinitions)
+    {
+        if (Definition)
+        {
+            AssetIds.AddUnique(Definition->GetPrimaryAssetId());
+        }
+    }
+
+    if (AssetIds.Num() > 0)
+    {
+        TArray<FName> Bundles = { UCardDefinition::PresentationBundle };
+        DeckLoadHandle = UAssetManager::Get().LoadPrimaryAssets(AssetIds, Bundles, FStreamableDelegate::CreateUObject(this, &AGamePlayerController::HandleDeckLoaded));
+    }
+
+    //No handle means there was nothing to load, or everything was already resident
+    if (!DeckLoadHandle.IsValid() || DeckLoadHandle->HasLoadCompleted())
+    {
+        HandleDeckLoaded();
+    }
+}
+
+void AGamePlayerController::HandleDeckLoaded()
+{
+    if (IsDeckLoaded)
+    {
+        return;
+    }
+
+    //Resolve widget classes now they're resident so draws don't have to
+    for (auto& CardData : DeckCards)
+    {
+        if (!CardData.CardClass)
         {
-            DeckCards.Add(CardWidget);
+            CardData.CardClass = CardData.GetWidgetClass();
         }
     }
 
-    Shuffle(DeckCards);
+    UE_LOG(LogGamePlayerController, Log, TEXT("[Deck] Loaded %d cards"), DeckCards.Num());
+
+    IsDeckLoaded = true;
+    OnDeckLoaded.Broadcast(this);
 }
 
 void AGamePlayerController::ResetCards()
@@ -31,20 +98,27 @@ UCardWidget* AGamePlayerController::DrawCard()
 {
     if (DeckCards.Num() > 0)
     {
-        UCardWidget* Card = nullptr;
+        FCardData CardData;
         if (HandCards.Num() == 0)
         {
-            if (auto CardPtr = DeckCards.FindByPredicate([](const UCardWidget* Card) { return Card->IsUnitCard; }))
+            int Index = DeckCards.IndexOfByPredicate([](const FCardData& Data) { return Data.IsUnitCard; });
+            if (Index != INDEX_NONE)
             {
-                Card = *CardPtr;
-                DeckCards.Remove(Card);
+                CardData = DeckCards[Index];
+                DeckCards.RemoveAt(Index);
             }
         }
-        if(!Card)
+        if (!CardData.IsValid())
         {
-            Card = DeckCards.Pop(false);
+            CardData = DeckCards.Pop(false);
+        }
+
+        UCardWidget* Card = AcquireCardWidget(CardData);
+        if (!Card)
+        {
+            DeckCards.Add(CardData);
+            return nullptr;
         }
-        check(Card);
 
         HandCards.Add(Card);
 
@@ -61,11 +135,19 @@ bool AGamePlayerController::DiscardCard(UCardWidget* Card)
     if (Card && HandCards.Contains(Card))
     {
         HandCards.Remove(Card);
-        DiscardCards.Add(Card);
+        DiscardCards.Add(Card->GetCardData());
+
+        if (Card->GetParent())
+        {
+            HandPanel = Card->GetParent();
+        }
 
         Card->Discarded();
         OnCardDiscarded.Broadcast(this, Card);
 
+        //The discard may still be playing, the widget is pooled once it's done
+        DiscardingWidgets.Add(Card);
+
         return true;
     }
     return false;
@@ -90,6 +172,148 @@ void AGamePlayerController::StartShuffle()
 void AGamePlayerController::EndShuffle()
 {
     DeckCards.Append(ShuffleCards);
-    Shuffle(DeckCards);
+    ShuffleDeck();
     OnShuffleEnded.Broadcast(this);
-}
\ No newline at end of file
+}
+
+void AGamePlayerController::CaptureCards(FGameStateSnapshot& Snapshot) const
+{
+    auto AddPile = [&Snapshot](const TArray<FCardData>& Pile, FGameStateSnapshot::ECardPile PileType)
+    {
+        for (const auto& CardData : Pile)
+        {
+            FGameStateSnapshot::FCardRecord Record;
+            Record.Definition = (int16)Snapshot.AddObject(CardData.Definition);
+            Record.CardClass = (int16)Snapshot.AddObject(CardData.CardClass.Get());
+            Record.Cost = (int16)CardData.Cost;
+            Record.Pile = PileType;
+            Record.IsUnitCard = CardData.IsUnitCard;
+            Snapshot.Cards.Add(Record);
+        }
+    };
+
+    AddPile(DeckCards, FGameStateSnapshot::ECardPile::Deck);
+    AddPile(DiscardCards, FGameStateSnapshot::ECardPile::Discard);
+    AddPile(ShuffleCards, FGameStateSnapshot::ECardPile::Shuffle);
+
+    TArray<FCardData> Hand;
+    Hand.Reserve(HandCards.Num());
+    for (auto Card : HandCards)
+    {
+        Hand.Add(Card->GetCardData());
+    }
+    AddPile(Hand, FGameStateSnapshot::ECardPile::Hand);
+}
+
+void AGamePlayerController::RestoreCards(const FGameStateSnapshot& Snapshot)
+{
+    //No Discarded or Drawn here, an undo or load shouldn't play a round of card SFX and animations
+    for (auto Card : HandCards)
+    {
+        if (Card->GetParent())
+        {
+            HandPanel = Card->GetParent();
+        }
+        Card->RemoveFromParent();
+        DiscardingWidgets.Add(Card);
+    }
+    HandCards.Reset();
+
+    DeckCards.Reset();
+    DiscardCards.Reset();
+    ShuffleCards.Reset();
+
+    for (const auto& Record : Snapshot.Cards)
+    {
+        FCardData CardData;
+        CardData.Definition = Snapshot.ResolveObject<UCardDefinition>(Record.Definition);
+        CardData.CardClass = Snapshot.ResolveObject<UClass>(Record.CardClass);
+        CardData.Cost = Record.Cost;
+        CardData.IsUnitCard = Record.IsUnitCard != 0;
+        if (!CardData.IsValid())
+        {
+            UE_LOG(LogGamePlayerController, Warning, TEXT("[Deck] Dropped a restored card that no longer resolves"));
+            continue;
+        }
+
+        switch (Record.Pile)
+        {
+        case FGameStateSnapshot::ECardPile::Deck: DeckCards.Add(CardData); break;
+        case FGameStateSnapshot::ECardPile::Discard: DiscardCards.Add(CardData); break;
+        case FGameStateSnapshot::ECardPile::Shuffle: ShuffleCards.Add(CardData); break;
+        case FGameStateSnapshot::ECardPile::Hand:
+            if (UCardWidget* Card = AcquireCardWidget(CardData))
+            {
+                HandCards.Add(Card);
+                if (HandPanel.IsValid())
+                {
+                    HandPanel->AddChild(Card);
+                }
+            }
+            break;
+        }
+    }
+
+    OnHandRestored.Broadcast(this);
+}
+
+void AGamePlayerController::ShuffleDeck()
+{
+    //The game mode's stream is part of its snapshots, so a restored game deals the same cards
+    auto VoidGameMode = GetWorld() ? GetWorld()->GetAuthGameMode<AVoidGameMode>() : nullptr;
+    if (VoidGameMode)
+    {
+        Shuffle(DeckCards, VoidGameMode->GetRandomStream());
+    }
+    else
+    {
+        Shuffle(DeckCards);
+    }
+}
+
+UCardWidget* AGamePlayerController::AcquireCardWidget(const FCardData& Data)
+{
+    ReclaimDiscardedWidgets();
+
+    TSubclassOf<UCardWidget> WidgetClass = Data.GetWidgetClass();
+    UCardWidget* Card = nullptr;
+    auto Pool = CardWidgetPools.Find(WidgetClass);
+    if (Pool && Pool->Widgets.Num() > 0)
+    {
+        Card = Pool->Widgets.Pop(false);
+    }
+    if (!Card)
+    {
+        Card = CreateWidget<UCardWidget>(this, WidgetClass);
+    }
+    if (Card)
+    {
+        Card->InitCard(Data);
+    }
+    return Card;
+}
+
+void AGamePlayerController::ReleaseCardWidget(UCardWidget* Card)
+{
+    if (Card)
+    {
+        CardWidgetPools.FindOrAdd(Card->GetClass()).Widgets.Add(Card);
+    }
+}
+
+void AGamePlayerController::ReclaimDiscardedWidgets()
+{
+    for (int i = DiscardingWidgets.Num() - 1; i >= 0; i--)
+    {
+        UCardWidget* Card = DiscardingWidgets[i];
+        if (!Card)
+        {
+            DiscardingWidgets.RemoveAtSwap(i, 1, false);
+        }
+        else if (!Card->GetParent() && !Card->IsInViewport() && !Card->IsPlayingAnimation())
+        {
+            DiscardingWidgets.RemoveAtSwap(i, 1, false);
+            ReleaseCardWidget(Card);
+        }
+    }
+}
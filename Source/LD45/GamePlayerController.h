@@ -4,13 +4,27 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/PlayerController.h"
+#include "CardWidget.h"
 #include "GamePlayerController.generated.h"
 
-class UCardWidget;
+class UCardDefinition;
+struct FStreamableHandle;
+struct FGameStateSnapshot;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FVoidPlayerEvent, AGamePlayerController*, Player);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FVoidPlayerCardEvent, AGamePlayerController*, Player, UCardWidget*, Card);
 
+USTRUCT()
+struct FCardWidgetPool
+{
+    GENERATED_BODY()
+
+public:
+
+    UPROPERTY(Transient)
+    TArray<UCardWidget*> Widgets;
+};
+
 /**
  * 
  */
@@ -43,17 +57,57 @@ public:
     UFUNCTION(BlueprintCallable)
     void EndShuffle();
 
+    UFUNCTION(BlueprintCallable)
+    bool GetIsDeckLoaded() const { return IsDeckLoaded; }
+
+    UFUNCTION(BlueprintPure)
+    int GetDeckCount() const { return DeckCards.Num(); }
+
+    UFUNCTION(BlueprintPure)
+    int GetDiscardCount() const { return DiscardCards.Num(); }
+
+    //Every pile including the hand, in order
+    void CaptureCards(FGameStateSnapshot& Snapshot) const;
+
+    //Replaces every pile without playing any draws or discards, OnHandRestored fires once the hand is rebuilt
+    void RestoreCards(const FGameStateSnapshot& Snapshot);
+
+private:
+
+    void ShuffleDeck();
+
+    void StartDeckLoad();
+    void HandleDeckLoaded();
+
+    UCardWidget* AcquireCardWidget(const FCardData& Data);
+    void ReleaseCardWidget(UCardWidget* Card);
+
+    //Moves discarded widgets whose presentation is over into their pools
+    void ReclaimDiscardedWidgets();
+
 public:
 
+    UPROPERTY(EditAnywhere, BlueprintReadOnly)
+    TArray<UCardDefinition*> DeckDefinitions;
+
+    //Legacy widget-class-per-card deck, loaded synchronously. Prefer DeckDefinitions
     UPROPERTY(EditAnywhere, BlueprintReadOnly)
     TArray<TSubclassOf<UCardWidget>> Deck;
 
+    //Broadcast once the deck's presentation assets have streamed in
+    UPROPERTY(BlueprintAssignable)
+    FVoidPlayerEvent OnDeckLoaded;
+
     UPROPERTY(BlueprintAssignable)
     FVoidPlayerCardEvent OnCardDrawn;
 
     UPROPERTY(BlueprintAssignable)
     FVoidPlayerCardEvent OnCardDiscarded;
 
+    //Restored hand widgets are already in the panel the old hand was in, UI that lays out the hand itself can do it here
+    UPROPERTY(BlueprintAssignable)
+    FVoidPlayerEvent OnHandRestored;
+
     UPROPERTY(BlueprintAssignable)
     FVoidPlayerEvent OnShuffleStarted;
 
@@ -62,16 +116,34 @@ public:
 
 protected:
 
+    //UI should read GetDeckCount and GetDiscardCount, the piles only hold card data
     UPROPERTY(Transient, BlueprintReadOnly)
-    TArray<UCardWidget*> DeckCards;
+    TArray<FCardData> DeckCards;
 
     UPROPERTY(Transient, BlueprintReadOnly)
-    TArray<UCardWidget*> DiscardCards;
+    TArray<FCardData> DiscardCards;
 
     UPROPERTY(Transient, BlueprintReadOnly)
-    TArray<UCardWidget*> ShuffleCards;
+    TArray<FCardData> ShuffleCards;
 
     UPROPERTY(Transient, BlueprintReadOnly)
     TArray<UCardWidget*> HandCards;
 
+private:
+
+    //Discarded widgets, keyed by widget class, reused on draw
+    UPROPERTY(Transient)
+    TMap<UClass*, FCardWidgetPool> CardWidgetPools;
+
+    //Discarded but still in the UI or animating, pooled once they're neither
+    UPROPERTY(Transient)
+    TArray<UCardWidget*> DiscardingWidgets;
+
+    //Where the UI put hand widgets, restored cards are added back to it
+    TWeakObjectPtr<class UPanelWidget> HandPanel;
+
+    TSharedPtr<FStreamableHandle> DeckLoadHandle;
+
+    bool IsDeckLoaded = false;
+
 };
@@ -0,0 +1,90 @@
+#include "GameStateSnapshot.h"
+#include "UObject/SoftObjectPath.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGameStateSnapshot, Log, All)
+
+namespace
+{
+    const uint32 GameStateSnapshotMagic = 0x50414E53; //"SNAP"
+    const int32 GameStateSnapshotVersion = 1;
+}
+
+void FGameStateSnapshot::Reset()
+{
+    MapId.Reset();
+    FlowState = 0;
+    RandomSeed = 0;
+    ObjectPaths.Reset();
+    ObjectIndices.Reset();
+    Entities.Reset();
+    PendingSpawns.Reset();
+    Attacks.Reset();
+    AttackLocations.Reset();
+    Cards.Reset();
+}
+
+int FGameStateSnapshot::AddObject(const UObject* Object)
+{
+    if (!Object)
+    {
+        return INDEX_NONE;
+    }
+    if (const int* Index = ObjectIndices.Find(Object))
+    {
+        return *Index;
+    }
+    const int Index = ObjectPaths.Add(Object->GetPathName());
+    ObjectIndices.Add(Object, Index);
+    return Index;
+}
+
+UObject* FGameStateSnapshot::ResolveObject(int Index) const
+{
+    return ObjectPaths.IsValidIndex(Index) ? FSoftObjectPath(ObjectPaths[Index]).TryLoad() : nullptr;
+}
+
+void FGameStateSnapshot::Write(TArray<uint8>& OutBytes)
+{
+    //Keeps the buffer's slack, ring buffers reuse the same allocation every turn
+    OutBytes.Reset();
+    FMemoryWriter Writer(OutBytes);
+    Serialize(Writer);
+}
+
+bool FGameStateSnapshot::Read(const TArray<uint8>& Bytes)
+{
+    Reset();
+    FMemoryReader Reader(Bytes);
+    Serialize(Reader);
+    if (Reader.IsError())
+    {
+        Reset();
+        return false;
+    }
+    return true;
+}
+
+void FGameStateSnapshot::Serialize(FArchive& Ar)
+{
+    uint32 Magic = GameStateSnapshotMagic;
+    int32 Version = GameStateSnapshotVersion;
+    Ar << Magic << Version;
+    if (Ar.IsLoading() && (Magic != GameStateSnapshotMagic || Version != GameStateSnapshotVersion))
+    {
+        UE_LOG(LogGameStateSnapshot, Error, TEXT("Unsupported snapshot (magic %x, version %d)"), Magic, Version);
+        Ar.SetError();
+        return;
+    }
+
+    Ar << MapId << FlowState << RandomSeed;
+    Ar << ObjectPaths;
+
+    //Plain old data, one memcpy per array
+    Entities.BulkSerialize(Ar);
+    PendingSpawns.BulkSerialize(Ar);
+    Attacks.BulkSerialize(Ar);
+    AttackLocations.BulkSerialize(Ar);
+    Cards.BulkSerialize(Ar);
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Casts.h"
+#include "Util.h"
+
+/**
+ * The whole game packed into plain records, for autosaves and undo. Written and read as one buffer,
+ * every record array goes through a single bulk copy and object references share one path table.
+ * Occupancy is the entity records' coords, restoring puts every entity straight back on its cell.
+ * Captured and restored by AVoidGameMode, see AVoidGameMode::CaptureSnapshot.
+ */
+struct LD45_API FGameStateSnapshot
+{
+public:
+
+    struct FEntityRecord
+    {
+        FHexMapCoord Coord;
+        int16 Class;
+        int16 Health;
+        int16 MaxHealth;
+        uint8 IsAttackPending;
+        uint8 Padding;
+
+        friend FArchive& operator<<(FArchive& Ar, FEntityRecord& Record)
+        {
+            return Ar << Record.Coord << Record.Class << Record.Health << Record.MaxHealth << Record.IsAttackPending << Record.Padding;
+        }
+    };
+
+    struct FSpawnRecord
+    {
+        FHexMapCoord Location;
+        int32 Class;
+
+        friend FArchive& operator<<(FArchive& Ar, FSpawnRecord& Record)
+        {
+            return Ar << Record.Location << Record.Class;
+        }
+    };
+
+    //A telegraphed attack, its cells are a slice of AttackLocations
+    struct FAttackRecord
+    {
+        int32 Entity;
+        int32 FirstLocation;
+        int32 NumLocations;
+
+        friend FArchive& operator<<(FArchive& Ar, FAttackRecord& Record)
+        {
+            return Ar << Record.Entity << Record.FirstLocation << Record.NumLocations;
+        }
+    };
+
+    enum class ECardPile : uint8
+    {
+        Deck,
+        Discard,
+        Shuffle,
+        Hand
+    };
+
+    struct FCardRecord
+    {
+        int16 Definition;
+        int16 CardClass;
+        int16 Cost;
+        ECardPile Pile;
+        uint8 IsUnitCard;
+
+        friend FArchive& operator<<(FArchive& Ar, FCardRecord& Record)
+        {
+            return Ar << Record.Definition << Record.CardClass << Record.Cost << (uint8&)Record.Pile << Record.IsUnitCard;
+        }
+    };
+
+    void Reset();
+
+    //INDEX_NONE for null, otherwise the object's slot in the path table
+    int AddObject(const UObject* Object);
+
+    //Objects are normally resident already, this only loads when restoring a save from an earlier session
+    UObject* ResolveObject(int Index) const;
+
+    template<typename T>
+    T* ResolveObject(int Index) const { return Cast<T>(ResolveObject(Index)); }
+
+    void Write(TArray<uint8>& OutBytes);
+    bool Read(const TArray<uint8>& Bytes);
+
+    void Serialize(FArchive& Ar);
+
+public:
+
+    FString MapId;
+    uint8 FlowState = 0;
+    int32 RandomSeed = 0;
+
+    TArray<FString> ObjectPaths;
+
+    TArray<FEntityRecord> Entities;
+    TArray<FSpawnRecord> PendingSpawns;
+    TArray<FAttackRecord> Attacks;
+    TArray<FHexMapCoord> AttackLocations;
+    TArray<FCardRecord> Cards;
+
+private:
+
+    //Paths already in ObjectPaths, only used while capturing
+    TMap<const UObject*, int> ObjectIndices;
+};
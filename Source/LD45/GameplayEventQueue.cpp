@@ -0,0 +1,120 @@
+#include "GameplayEventQueue.h"
+#include "Engine/World.h"
+#include "MapEntity.h"
+#include "HexCell.h"
+#include "VoidGameMode.h"
+#include "LD45Stats.h"
+
+FGameplayEventQueue* FGameplayEventQueue::Get(const UObject* WorldContextObject)
+{
+    UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+    AVoidGameMode* GameMode = World ? World->GetAuthGameMode<AVoidGameMode>() : nullptr;
+    return GameMode ? &GameMode->GetEventQueue() : nullptr;
+}
+
+void FGameplayEvent::AddReferencedObjects(FReferenceCollector& Collector)
+{
+    Collector.AddReferencedObject(Entity);
+    Collector.AddReferencedObject(FromCell);
+    Collector.AddReferencedObject(ToCell);
+}
+
+void FGameplayEventQueue::AddReferencedObjects(FReferenceCollector& Collector)
+{
+    for (auto& Event : Events)
+    {
+        Event.AddReferencedObjects(Collector);
+    }
+    for (auto& Event : DispatchingEvents)
+    {
+        Event.AddReferencedObjects(Collector);
+    }
+    for (auto& Attack : Attacks)
+    {
+        AddAttackReferences(Collector, Attack);
+    }
+    for (auto& Attack : DispatchingAttacks)
+    {
+        AddAttackReferences(Collector, Attack);
+    }
+}
+
+void FGameplayEventQueue::AddAttackReferences(FReferenceCollector& Collector, FMapAttackInfo& Attack)
+{
+    Collector.AddReferencedObject(Attack.Source);
+    Collector.AddReferencedObjects(Attack.Hits);
+}
+
+FGameplayEvent& FGameplayEventQueue::Push(EGameplayEventType Type, AMapEntity* Entity)
+{
+    INC_DWORD_STAT(STAT_LD45_EventsQueued);
+
+    FGameplayEvent& Event = Events[Events.AddDefaulted()];
+    Event.Type = Type;
+    Event.Entity = Entity;
+    return Event;
+}
+
+void FGameplayEventQueue::PushMove(AMapEntity* Entity, AHexCell* FromCell, AHexCell* ToCell)
+{
+    FGameplayEvent& Event = Push(EGameplayEventType::Move, Entity);
+    Event.FromCell = FromCell;
+    Event.ToCell = ToCell;
+}
+
+void FGameplayEventQueue::PushAttack(AMapEntity* Entity, const FMapAttackInfo& Attack, int NumHits)
+{
+    FGameplayEvent& Event = Push(EGameplayEventType::Attack, Entity);
+    Event.NumHits = (uint16)NumHits;
+    Event.Payload = Attacks.Add(Attack);
+}
+
+void FGameplayEventQueue::PushHealthChanged(AMapEntity* Entity)
+{
+    if (!HealthChangedEvents.Contains(Entity))
+    {
+        HealthChangedEvents.Add(Entity, Events.Num());
+        Push(EGameplayEventType::HealthChanged, Entity);
+    }
+}
+
+void FGameplayEventQueue::PushDeath(AMapEntity* Entity)
+{
+    Push(EGameplayEventType::Death, Entity);
+}
+
+void FGameplayEventQueue::Flush()
+{
+    if (IsFlushing || Events.Num() == 0)
+    {
+        return; //A listener flushing mid batch leaves it to the outer loop
+    }
+
+    LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_EventDispatch);
+
+    IsFlushing = true;
+    while (Events.Num() > 0)
+    {
+        Swap(Events, DispatchingEvents);
+        Swap(Attacks, DispatchingAttacks);
+        HealthChangedEvents.Reset();
+
+        OnDispatch.Broadcast(DispatchingEvents, *this);
+
+        //Blueprint adapter, same order and payloads as the old per call broadcasts
+        if (BlueprintAdapterEnabled)
+        {
+            for (const auto& Event : DispatchingEvents)
+            {
+                if (Event.Entity)
+                {
+                    Event.Entity->BroadcastGameplayEvent(Event, Event.Type == EGameplayEventType::Attack ? &GetAttack(Event) : nullptr);
+                }
+            }
+        }
+
+        DispatchingEvents.Reset();
+        DispatchingAttacks.Reset();
+    }
+    IsFlushing = false;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/GCObject.h"
+#include "Util.h"
+
+class AMapEntity;
+class AHexCell;
+
+enum class EGameplayEventType : uint8
+{
+    Move,
+    Attack,
+    HealthChanged,
+    Death
+};
+
+struct FGameplayEvent
+{
+    EGameplayEventType Type;
+
+    //Attack events, Payload indexes the batch's attacks and NumHits is how many entities it struck
+    uint16 NumHits = 0;
+    int Payload = INDEX_NONE;
+
+    //Held strongly by whoever stores the event, a dead entity is usually destroyed before its death goes out
+    AMapEntity* Entity = nullptr;
+    AHexCell* FromCell = nullptr;
+    AHexCell* ToCell = nullptr;
+
+    void AddReferencedObjects(FReferenceCollector& Collector);
+};
+
+/**
+ * Gameplay events recorded during a simulation step and handed out in batches at sync points,
+ * instead of each one going through a dynamic delegate as it happens.
+ * Listeners see the whole batch, after which the entities' blueprint delegates are broadcast in order.
+ * Queued events keep their entities, cells and attack payloads alive, so an entity destroyed by its own
+ * death still has its delegates broadcast.
+ * Owned by AVoidGameMode; without one events are broadcast straight away.
+ */
+class LD45_API FGameplayEventQueue : public FGCObject
+{
+public:
+
+    DECLARE_MULTICAST_DELEGATE_TwoParams(FOnDispatch, TArrayView<const FGameplayEvent> /*Events*/, const FGameplayEventQueue& /*Queue*/);
+
+    static FGameplayEventQueue* Get(const UObject* WorldContextObject);
+
+    void PushMove(AMapEntity* Entity, AHexCell* FromCell, AHexCell* ToCell);
+    void PushAttack(AMapEntity* Entity, const FMapAttackInfo& Attack, int NumHits);
+
+    //Several changes to one entity in a batch arrive as one event
+    void PushHealthChanged(AMapEntity* Entity);
+    void PushDeath(AMapEntity* Entity);
+
+    //Dispatches until nothing is left, events pushed by listeners go out in a following batch
+    void Flush();
+
+    const FMapAttackInfo& GetAttack(const FGameplayEvent& Event) const { return DispatchingAttacks[Event.Payload]; }
+
+    int Num() const { return Events.Num(); }
+
+    //Off when something else, like the presentation timeline, broadcasts the blueprint delegates later
+    void SetBlueprintAdapterEnabled(bool Enabled) { BlueprintAdapterEnabled = Enabled; }
+
+    FOnDispatch OnDispatch;
+
+    //FGCObject
+    virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+    virtual FString GetReferencerName() const override { return TEXT("FGameplayEventQueue"); }
+
+    static void AddAttackReferences(FReferenceCollector& Collector, FMapAttackInfo& Attack);
+
+private:
+
+    FGameplayEvent& Push(EGameplayEventType Type, AMapEntity* Entity);
+
+    TArray<FGameplayEvent> Events;
+    TArray<FMapAttackInfo> Attacks;
+
+    //Swapped in while a batch is dispatched
+    TArray<FGameplayEvent> DispatchingEvents;
+    TArray<FMapAttackInfo> DispatchingAttacks;
+
+    TMap<const AMapEntity*, int> HealthChangedEvents;
+
+    bool IsFlushing = false;
+    bool BlueprintAdapterEnabled = true;
+};
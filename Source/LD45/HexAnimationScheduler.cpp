@@ -0,0 +1,129 @@
+#include "HexAnimationScheduler.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "VoidGameMode.h"
+#include "LD45Stats.h"
+
+UHexAnimationScheduler* UHexAnimationScheduler::GetAnimationScheduler(const UObject* WorldContextObject)
+{
+    UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+    AVoidGameMode* GameMode = World ? World->GetAuthGameMode<AVoidGameMode>() : nullptr;
+    return GameMode ? GameMode->GetAnimationScheduler() : nullptr;
+}
+
+int UHexAnimationScheduler::Play(UObject* Owner, FUpdateFunc Update, bool WakeOwnerTick)
+{
+    AActor* Actor = WakeOwnerTick ? Cast<AActor>(Owner) : nullptr;
+    if (Actor)
+    {
+        int& Count = WakeCounts.FindOrAdd(Actor);
+        if (Count++ == 0)
+        {
+            Actor->SetActorTickEnabled(true);
+        }
+    }
+
+    const int Id = NextAnimationId++;
+    Animations.Add({ Id, Owner, Actor, MoveTemp(Update), true });
+    return Id;
+}
+
+int UHexAnimationScheduler::PlayTimed(UObject* Owner, float Duration, TFunction<void(float Alpha)> Update, bool WakeOwnerTick)
+{
+    float Elapsed = 0.0f;
+    return Play(Owner, [Elapsed, Duration, Update](float DeltaTime) mutable
+    {
+        Elapsed += DeltaTime;
+        const float Alpha = Duration > 0.0f ? FMath::Min(Elapsed / Duration, 1.0f) : 1.0f;
+        Update(Alpha);
+        return Alpha < 1.0f;
+    }, WakeOwnerTick);
+}
+
+int UHexAnimationScheduler::PlayTimedEvent(UObject* Owner, float Duration, FHexAnimationAlphaEvent OnUpdate, bool WakeOwnerTick)
+{
+    return PlayTimed(Owner, Duration, [OnUpdate](float Alpha) { OnUpdate.ExecuteIfBound(Alpha); }, WakeOwnerTick);
+}
+
+void UHexAnimationScheduler::Cancel(int AnimationId)
+{
+    for (auto& Animation : Animations)
+    {
+        if (Animation.Id == AnimationId)
+        {
+            Animation.IsActive = false; //Removed at the end of the next tick
+        }
+    }
+}
+
+void UHexAnimationScheduler::CancelAll(UObject* Owner)
+{
+    for (auto& Animation : Animations)
+    {
+        if (Animation.Owner == Owner)
+        {
+            Animation.IsActive = false;
+        }
+    }
+}
+
+bool UHexAnimationScheduler::IsAnimating(const UObject* Owner) const
+{
+    return Animations.ContainsByPredicate([Owner](const FAnimation& Animation) { return Animation.IsActive && Animation.Owner == Owner; });
+}
+
+bool UHexAnimationScheduler::IsActive(int AnimationId) const
+{
+    return Animations.ContainsByPredicate([AnimationId](const FAnimation& Animation) { return Animation.IsActive && Animation.Id == AnimationId && Animation.Owner.IsValid(); });
+}
+
+void UHexAnimationScheduler::Tick(float DeltaTime)
+{
+    //Work added from an update starts next frame
+    const int NumToUpdate = Animations.Num();
+    for (int i = 0; i < NumToUpdate; i++)
+    {
+        if (!Animations[i].IsActive || !Animations[i].Owner.IsValid())
+        {
+            Animations[i].IsActive = false;
+            continue;
+        }
+
+        //Moved out as the update may add work and reallocate the array
+        FUpdateFunc Update = MoveTemp(Animations[i].Update);
+        const bool IsRunning = Update(DeltaTime);
+        Animations[i].Update = MoveTemp(Update);
+        Animations[i].IsActive &= IsRunning;
+    }
+
+    for (int i = Animations.Num() - 1; i >= 0; i--)
+    {
+        if (!Animations[i].IsActive)
+        {
+            Finish(i);
+        }
+    }
+}
+
+TStatId UHexAnimationScheduler::GetStatId() const
+{
+    return GET_STATID(STAT_LD45_Animation);
+}
+
+void UHexAnimationScheduler::Finish(int Index)
+{
+    const FAnimation& Animation = Animations[Index];
+    if (!Animation.WokenActor.IsExplicitlyNull())
+    {
+        int* Count = WakeCounts.Find(Animation.WokenActor);
+        if (Count && --(*Count) == 0)
+        {
+            WakeCounts.Remove(Animation.WokenActor);
+            if (AActor* Actor = Animation.WokenActor.Get())
+            {
+                Actor->SetActorTickEnabled(false);
+            }
+        }
+    }
+    Animations.RemoveAt(Index, 1, false);
+}
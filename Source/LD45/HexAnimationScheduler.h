@@ -0,0 +1,79 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Tickable.h"
+#include "HexAnimationScheduler.generated.h"
+
+DECLARE_DYNAMIC_DELEGATE_OneParam(FHexAnimationAlphaEvent, float, Alpha);
+
+/**
+ * Runs time bounded visual work (map transitions, move tweens, highlight fades) from one tick.
+ * Owners register work here instead of ticking themselves, nothing is ticked while it's idle.
+ * Owned by AVoidGameMode, one per game world.
+ */
+UCLASS()
+class LD45_API UHexAnimationScheduler : public UObject, public FTickableGameObject
+{
+    GENERATED_BODY()
+
+public:
+
+    //Return false once finished
+    typedef TFunction<bool(float DeltaTime)> FUpdateFunc;
+
+    //Null outside a game world with a VoidGameMode, callers should fall back to ticking themselves
+    UFUNCTION(BlueprintPure, meta = (WorldContext = "WorldContextObject"))
+    static UHexAnimationScheduler* GetAnimationScheduler(const UObject* WorldContextObject);
+
+    //Work is dropped if Owner goes away. WakeOwnerTick keeps an actor owner's own tick on while it has work here
+    int Play(UObject* Owner, FUpdateFunc Update, bool WakeOwnerTick = false);
+
+    //Calls Update with 0-1 over Duration, always finishing on 1
+    int PlayTimed(UObject* Owner, float Duration, TFunction<void(float Alpha)> Update, bool WakeOwnerTick = false);
+
+    UFUNCTION(BlueprintCallable, meta = (DisplayName = "Play Timed"))
+    int PlayTimedEvent(UObject* Owner, float Duration, FHexAnimationAlphaEvent OnUpdate, bool WakeOwnerTick = false);
+
+    UFUNCTION(BlueprintCallable)
+    void Cancel(int AnimationId);
+
+    UFUNCTION(BlueprintCallable)
+    void CancelAll(UObject* Owner);
+
+    UFUNCTION(BlueprintPure)
+    bool IsAnimating(const UObject* Owner) const;
+
+    //False once the work has finished, been cancelled or dropped with its owner
+    UFUNCTION(BlueprintPure)
+    bool IsActive(int AnimationId) const;
+
+    UFUNCTION(BlueprintPure)
+    int GetNumAnimations() const { return Animations.Num(); }
+
+public:
+
+    //FTickableGameObject
+    void Tick(float DeltaTime) override;
+    bool IsTickable() const override { return Animations.Num() > 0; }
+    TStatId GetStatId() const override;
+
+private:
+
+    void Finish(int Index);
+
+    struct FAnimation
+    {
+        int Id;
+        TWeakObjectPtr<UObject> Owner;
+        TWeakObjectPtr<AActor> WokenActor;
+        FUpdateFunc Update;
+        bool IsActive;
+    };
+    TArray<FAnimation> Animations;
+
+    //Running work per woken actor, its tick goes off again when this hits 0
+    TMap<TWeakObjectPtr<AActor>, int> WakeCounts;
+
+    int NextAnimationId = 1;
+};
@@ -0,0 +1,292 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Util.h"
+
+namespace HexBitboardDetail
+{
+    //Bit x takes bit x - 1, carrying across words
+    FORCEINLINE uint64 ShiftUp(const uint64* Row, int WordIndex)
+    {
+        return (Row[WordIndex] << 1) | (WordIndex > 0 ? Row[WordIndex - 1] >> 63 : 0);
+    }
+
+    //Bit x takes bit x + 1, carrying across words
+    FORCEINLINE uint64 ShiftDown(const uint64* Row, int WordIndex, int WordsPerRow)
+    {
+        return (Row[WordIndex] >> 1) | (WordIndex + 1 < WordsPerRow ? Row[WordIndex + 1] << 63 : 0);
+    }
+
+    FORCEINLINE uint64 ShiftBy(const uint64* Row, int WordIndex, int WordsPerRow, int dx)
+    {
+        return dx > 0 ? ShiftUp(Row, WordIndex) : (dx < 0 ? ShiftDown(Row, WordIndex, WordsPerRow) : Row[WordIndex]);
+    }
+}
+
+/**
+ * One bit per cell, rows padded to whole 64 bit words so neighbour steps are word wide shifts.
+ * Neighbours follow the odd row offset layout of GetDirectionsAt.
+ * The allocator only decides where the words live, e.g. FTurnArenaAllocator for per query scratch.
+ */
+template <typename AllocatorType = FDefaultAllocator>
+struct THexBitboard
+{
+public:
+
+    void Init(int InWidth, int InHeight)
+    {
+        Width = InWidth;
+        Height = InHeight;
+        WordsPerRow = (Width + 63) / 64;
+        LastWordMask = (Width & 63) ? (uint64(1) << (Width & 63)) - 1 : ~uint64(0);
+        Words.Init(0, WordsPerRow * Height);
+    }
+
+    void Reset()
+    {
+        FMemory::Memzero(Words.GetData(), Words.Num() * sizeof(uint64));
+    }
+
+    template <typename OtherAllocatorType>
+    void CopyFrom(const THexBitboard<OtherAllocatorType>& Other)
+    {
+        Width = Other.Width;
+        Height = Other.Height;
+        WordsPerRow = Other.WordsPerRow;
+        LastWordMask = Other.LastWordMask;
+        Words.Reset(Other.Words.Num());
+        Words.Append(Other.Words);
+    }
+
+    FORCEINLINE bool IsValid(const FHexMapCoord& Coord) const { return Coord.IsValid(Width, Height); }
+
+    FORCEINLINE bool Get(const FHexMapCoord& Coord) const
+    {
+        return IsValid(Coord) && (Words[Coord.y * WordsPerRow + (Coord.x >> 6)] >> (Coord.x & 63)) & 1;
+    }
+
+    FORCEINLINE void Set(const FHexMapCoord& Coord, bool Value = true)
+    {
+        if (IsValid(Coord))
+        {
+            uint64& Word = Words[Coord.y * WordsPerRow + (Coord.x >> 6)];
+            const uint64 Bit = uint64(1) << (Coord.x & 63);
+            Word = Value ? (Word | Bit) : (Word & ~Bit);
+        }
+    }
+
+    bool IsEmpty() const
+    {
+        for (uint64 Word : Words)
+        {
+            if (Word)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int Num() const
+    {
+        int Count = 0;
+        for (uint64 Word : Words)
+        {
+            Count += FPlatformMath::CountBits(Word);
+        }
+        return Count;
+    }
+
+    //Boards must be the same size
+    template <typename OtherAllocatorType>
+    void And(const THexBitboard<OtherAllocatorType>& Other)
+    {
+        check(Other.Words.Num() == Words.Num());
+        for (int i = 0; i < Words.Num(); i++)
+        {
+            Words[i] &= Other.Words[i];
+        }
+    }
+
+    template <typename OtherAllocatorType>
+    void Or(const THexBitboard<OtherAllocatorType>& Other)
+    {
+        check(Other.Words.Num() == Words.Num());
+        for (int i = 0; i < Words.Num(); i++)
+        {
+            Words[i] |= Other.Words[i];
+        }
+    }
+
+    template <typename OtherAllocatorType>
+    void AndNot(const THexBitboard<OtherAllocatorType>& Other)
+    {
+        check(Other.Words.Num() == Words.Num());
+        for (int i = 0; i < Words.Num(); i++)
+        {
+            Words[i] &= ~Other.Words[i];
+        }
+    }
+
+    //Grows the set by Steps rings. Only rows in [MinRow, MaxRow] are touched, anything that would spill outside is dropped
+    void Dilate(int Steps, int MinRow = 0, int MaxRow = MAX_int32)
+    {
+        using namespace HexBitboardDetail;
+
+        MinRow = FMath::Max(MinRow, 0);
+        MaxRow = FMath::Min(MaxRow, Height - 1);
+        if (Steps <= 0 || MinRow > MaxRow)
+        {
+            return;
+        }
+
+        //Each step reads the previous step's rows, so they're copied out first
+        const int NumRows = MaxRow - MinRow + 1;
+        TArray<uint64, TInlineAllocator<64>> Previous;
+        Previous.SetNumUninitialized(NumRows * WordsPerRow);
+
+        for (int Step = 0; Step < Steps; Step++)
+        {
+            FMemory::Memcpy(Previous.GetData(), &Words[MinRow * WordsPerRow], NumRows * WordsPerRow * sizeof(uint64));
+
+            for (int Row = 0; Row < NumRows; Row++)
+            {
+                const int y = MinRow + Row;
+                const uint64* Same = &Previous[Row * WordsPerRow];
+                const uint64* Above = Row > 0 ? &Previous[(Row - 1) * WordsPerRow] : nullptr;
+                const uint64* Below = Row + 1 < NumRows ? &Previous[(Row + 1) * WordsPerRow] : nullptr;
+
+                //Even rows reach x - 1 and x in the rows either side, odd rows x and x + 1
+                const bool IsOdd = (y & 1) != 0;
+
+                uint64* Out = &Words[y * WordsPerRow];
+                for (int w = 0; w < WordsPerRow; w++)
+                {
+                    uint64 Word = Same[w] | ShiftUp(Same, w) | ShiftDown(Same, w, WordsPerRow);
+                    if (Above)
+                    {
+                        Word |= Above[w] | (IsOdd ? ShiftDown(Above, w, WordsPerRow) : ShiftUp(Above, w));
+                    }
+                    if (Below)
+                    {
+                        Word |= Below[w] | (IsOdd ? ShiftDown(Below, w, WordsPerRow) : ShiftUp(Below, w));
+                    }
+                    Out[w] = Word;
+                }
+                Out[WordsPerRow - 1] &= LastWordMask;
+            }
+        }
+    }
+
+    //Every set cell moved one step in Direction (GetDirectionsAt order), cells stepping off the board are dropped
+    template <typename OutAllocatorType>
+    void Shift(int Direction, THexBitboard<OutAllocatorType>& Out) const
+    {
+        using namespace HexBitboardDetail;
+
+        if (Out.Width != Width || Out.Height != Height)
+        {
+            Out.Init(Width, Height);
+        }
+        else
+        {
+            Out.Reset();
+        }
+
+        for (int y = 0; y < Height; y++)
+        {
+            const FHexMapCoord& Step = GetDirectionsAt(FHexMapCoord(0, y))[Direction];
+            const int DestY = y + Step.y;
+            if (DestY < 0 || DestY >= Height)
+            {
+                continue;
+            }
+
+            const uint64* Row = &Words[y * WordsPerRow];
+            uint64* DestRow = &Out.Words[DestY * WordsPerRow];
+            for (int w = 0; w < WordsPerRow; w++)
+            {
+                DestRow[w] |= ShiftBy(Row, w, WordsPerRow, Step.x);
+            }
+            DestRow[WordsPerRow - 1] &= LastWordMask;
+        }
+    }
+
+    //Set cells in row major order
+    template <typename OutAllocatorType>
+    void GetCoords(TArray<FHexMapCoord, OutAllocatorType>& OutCoords) const
+    {
+        for (int y = 0; y < Height; y++)
+        {
+            for (int w = 0; w < WordsPerRow; w++)
+            {
+                uint64 Word = Words[y * WordsPerRow + w];
+                while (Word)
+                {
+                    const int Bit = int(FPlatformMath::CountTrailingZeros64(Word));
+                    OutCoords.Emplace(w * 64 + Bit, y);
+                    Word &= Word - 1;
+                }
+            }
+        }
+    }
+
+public:
+
+    int Width = 0;
+    int Height = 0;
+    int WordsPerRow = 0;
+
+    TArray<uint64, AllocatorType> Words;
+
+private:
+
+    template <typename OtherAllocatorType>
+    friend struct THexBitboard;
+
+    //Valid bits of the last word in each row
+    uint64 LastWordMask = 0;
+};
+
+typedef THexBitboard<> FHexBitboard;
+
+/**
+ * Whole board queries built from flag boards, the maths behind AHexMap's bitboard queries
+ */
+namespace HexBitboardQueries
+{
+    //Sources grown by Radius rings
+    inline void ZoneOfControl(const FHexBitboard& Sources, int Radius, FHexBitboard& OutZone)
+    {
+        OutZone = Sources;
+        OutZone.Dilate(Radius);
+    }
+
+    //Cells hit by rays of Distance in every direction from every source at once, matching AMapEntity::GetAttacks:
+    //walls stop a ray, holes are passed over without being hit, occupied cells are hit and stop it
+    inline void AttackMask(const FHexBitboard& Sources, int Distance, const FHexBitboard& Exists, const FHexBitboard& Traversable, const FHexBitboard& Occupied, FHexBitboard& OutMask)
+    {
+        OutMask.Init(Sources.Width, Sources.Height);
+
+        FHexBitboard Walls = Exists;
+        Walls.AndNot(Traversable);
+
+        FHexBitboard Ray, Next, Hit;
+        for (int Direction = 0; Direction < 6; Direction++)
+        {
+            Ray = Sources;
+            for (int Step = 0; Step < Distance && !Ray.IsEmpty(); Step++)
+            {
+                Ray.Shift(Direction, Next);
+                Next.AndNot(Walls);
+
+                Hit = Next;
+                Hit.And(Traversable);
+                OutMask.Or(Hit);
+
+                Next.AndNot(Occupied);
+                Swap(Ray, Next);
+            }
+        }
+    }
+}
@@ -1,15 +1,23 @@
 #include "HexCell.h"
 #include "HexMap.h"
 #include "MapEntity.h"
+#include "HexAnimationScheduler.h"
 
 AHexCell::AHexCell()
 {
     IsTraversable = true;
+    TickOnlyWhileAnimating = false;
+    HighlightFadeDuration = 0.25f;
 }
 
 void AHexCell::BeginPlay()
 {
 	Super::BeginPlay();
+
+    if (TickOnlyWhileAnimating)
+    {
+        SetActorTickEnabled(false);
+    }
 }
 
 void AHexCell::EndPlay(EEndPlayReason::Type EndPlayReason)
@@ -43,7 +51,30 @@ void AHexCell::SetMapCoord(const FHexMapCoord& Coord)
 
 void AHexCell::SetOccupyingEntity(AMapEntity* Entity)
 {
-    OccupyingEntity = Entity;
+    if (OccupyingEntity != Entity)
+    {
+        OccupyingEntity = Entity;
+        if (AHexMap* Map = GetOwningMap())
+        {
+            Map->NotifyCellChanged(this);
+        }
+    }
+}
+
+void AHexCell::PlayHighlightFade()
+{
+    if (TickOnlyWhileAnimating)
+    {
+        if (auto Scheduler = UHexAnimationScheduler::GetAnimationScheduler(this))
+        {
+            Scheduler->CancelAll(this);
+            Scheduler->PlayTimed(this, HighlightFadeDuration, [](float) {}, true);
+        }
+        else
+        {
+            SetActorTickEnabled(true); //Nothing to turn it back off
+        }
+    }
 }
 
 void AHexCell::HighlightCell_Implementation(FColor Color)
@@ -49,6 +49,9 @@ public:
 
     UFUNCTION(BlueprintCallable)
     bool GetIsHighlighted() const { return IsHighlighted; }
+
+    //Keeps the actor ticking for HighlightFadeDuration after any highlight change, when it only ticks while animating
+    void PlayHighlightFade();
     
 public:
 
@@ -74,6 +77,13 @@ protected:
     UPROPERTY(EditAnywhere, BlueprintReadWrite)
     AMapEntity* OccupyingEntity;
 
+    //Actor tick stays off except during highlight fades, for blueprints that only animate in Tick
+    UPROPERTY(EditDefaultsOnly, Category = Animation)
+    bool TickOnlyWhileAnimating;
+
+    UPROPERTY(EditDefaultsOnly, Category = Animation, meta = (EditCondition = "TickOnlyWhileAnimating"))
+    float HighlightFadeDuration;
+
 private:
 
     FHexMapCoord HexMapCoord;
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Util.h"
+
+/**
+ * Insertion ordered set of map coordinates.
+ * Membership is a bit test when constructed with the map bounds, otherwise an open addressing hash of packed coords.
+ * Stands in for AddUnique and Contains on coordinate arrays, e.g. move ranges and attack locations.
+ */
+class FHexCoordSet
+{
+public:
+
+    //Unbounded, hashed
+    FHexCoordSet() {}
+
+    //Bounded to a Width x Height map, coords outside it are rejected
+    FHexCoordSet(int InWidth, int InHeight)
+        : Width(InWidth)
+        , Height(InHeight)
+    {
+        Bits.Init(false, Width * Height);
+    }
+
+    FORCEINLINE bool IsBounded() const { return Width > 0; }
+
+    FORCEINLINE int Num() const { return Elements.Num(); }
+
+    FORCEINLINE const FHexMapCoord& operator [] (int Index) const { return Elements[Index]; }
+
+    FORCEINLINE const TArray<FHexMapCoord>& GetElements() const { return Elements; }
+
+    FORCEINLINE void Reserve(int Number)
+    {
+        Elements.Reserve(Number);
+        if (!IsBounded())
+        {
+            GrowSlots(Number * 2);
+        }
+    }
+
+    bool Contains(const FHexMapCoord& Coord) const
+    {
+        if (IsBounded())
+        {
+            return Coord.IsValid(Width, Height) && Bits[Coord.x + Coord.y * Width];
+        }
+        return Slots.Num() > 0 && Slots[FindSlot(Coord)] != INDEX_NONE;
+    }
+
+    //Insertion index of the coord or INDEX_NONE, constant time when hashed, bounded sets search their elements
+    int Find(const FHexMapCoord& Coord) const
+    {
+        if (IsBounded())
+        {
+            return Contains(Coord) ? Elements.IndexOfByKey(Coord) : INDEX_NONE;
+        }
+        return Slots.Num() > 0 ? Slots[FindSlot(Coord)] : INDEX_NONE;
+    }
+
+    //Returns true if the coord wasn't already in the set
+    bool Add(const FHexMapCoord& Coord)
+    {
+        if (IsBounded())
+        {
+            if (!Coord.IsValid(Width, Height))
+            {
+                return false;
+            }
+            FBitReference Bit = Bits[Coord.x + Coord.y * Width];
+            if (Bit)
+            {
+                return false;
+            }
+            Bit = true;
+        }
+        else
+        {
+            if ((Elements.Num() + 1) * 2 > Slots.Num())
+            {
+                GrowSlots(FMath::Max(16, Slots.Num() * 2));
+            }
+            int Slot = FindSlot(Coord);
+            if (Slots[Slot] != INDEX_NONE)
+            {
+                return false;
+            }
+            Slots[Slot] = Elements.Num();
+        }
+        Elements.Add(Coord);
+        return true;
+    }
+
+    void Reset()
+    {
+        if (IsBounded())
+        {
+            for (const auto& Coord : Elements)
+            {
+                Bits[Coord.x + Coord.y * Width] = false;
+            }
+        }
+        else
+        {
+            for (auto& Slot : Slots)
+            {
+                Slot = INDEX_NONE;
+            }
+        }
+        Elements.Reset();
+    }
+
+    FORCEINLINE TArray<FHexMapCoord>::RangedForConstIteratorType begin() const { return Elements.begin(); }
+    FORCEINLINE TArray<FHexMapCoord>::RangedForConstIteratorType end() const { return Elements.end(); }
+
+private:
+
+    //Slots hold insertion indices, probing compares the elements they point at
+    int FindSlot(const FHexMapCoord& Coord) const
+    {
+        const int Mask = Slots.Num() - 1;
+        int Slot = FHexMapCoord::HashKey(Coord.Pack()) & Mask;
+        while (Slots[Slot] != INDEX_NONE && Elements[Slots[Slot]] != Coord)
+        {
+            Slot = (Slot + 1) & Mask;
+        }
+        return Slot;
+    }
+
+    void GrowSlots(int MinSlots)
+    {
+        int NewNum = FMath::RoundUpToPowerOfTwo(FMath::Max(MinSlots, 16));
+        if (NewNum <= Slots.Num())
+        {
+            return;
+        }
+        Slots.Init(INDEX_NONE, NewNum);
+        for (int Index = 0; Index < Elements.Num(); Index++)
+        {
+            Slots[FindSlot(Elements[Index])] = Index;
+        }
+    }
+
+private:
+
+    int Width = 0;
+    int Height = 0;
+
+    TArray<FHexMapCoord> Elements;
+    TBitArray<> Bits;
+    TArray<int> Slots;
+};
@@ -0,0 +1,121 @@
+#include "HexFieldOfView.h"
+#include "HexMath.h"
+
+namespace
+{
+    //Sorted, merged set of blocked angles in turns [0,1)
+    class FShadowIntervals
+    {
+    public:
+
+        bool IsBlocked(float Angle) const
+        {
+            for (const auto& Interval : Intervals)
+            {
+                if (Angle < Interval.X)
+                {
+                    return false;
+                }
+                if (Angle <= Interval.Y)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool IsFullyBlocked() const
+        {
+            return Intervals.Num() == 1 && Intervals[0].X <= 0.0f && Intervals[0].Y >= 1.0f;
+        }
+
+        void Add(float Start, float End)
+        {
+            //Split slices that wrap past zero
+            if (Start < 0.0f)
+            {
+                AddUnwrapped(Start + 1.0f, 1.0f);
+                Start = 0.0f;
+            }
+            if (End > 1.0f)
+            {
+                AddUnwrapped(0.0f, End - 1.0f);
+                End = 1.0f;
+            }
+            AddUnwrapped(Start, End);
+        }
+
+    private:
+
+        void AddUnwrapped(float Start, float End)
+        {
+            int Index = 0;
+            while (Index < Intervals.Num() && Intervals[Index].Y < Start)
+            {
+                Index++;
+            }
+
+            FVector2D Merged(Start, End);
+            while (Index < Intervals.Num() && Intervals[Index].X <= End)
+            {
+                Merged.X = FMath::Min(Merged.X, Intervals[Index].X);
+                Merged.Y = FMath::Max(Merged.Y, Intervals[Index].Y);
+                Intervals.RemoveAt(Index, 1, false);
+            }
+            Intervals.Insert(Merged, Index);
+        }
+
+        TArray<FVector2D, TInlineAllocator<16>> Intervals;
+    };
+}
+
+void ComputeHexFieldOfView(const TArray<uint8>& CellFlags, int Width, int Height, const FHexMapCoord& Source, int Radius, TBitArray<>& OutVisible)
+{
+    OutVisible.Init(false, Width * Height);
+    if (!Source.IsValid(Width, Height))
+    {
+        return;
+    }
+    OutVisible[Source.x + Source.y * Width] = true;
+
+    const FHexAxial Center = HexMath::OffsetToAxial(Source);
+    FShadowIntervals Shadows;
+
+    for (int Ring = 1; Ring <= Radius && !Shadows.IsFullyBlocked(); Ring++)
+    {
+        //Slices are added after the ring so cells in the same ring don't shadow each other
+        TArray<FVector2D, TInlineAllocator<32>> NewShadows;
+
+        const float SliceSize = 1.0f / float(6 * Ring);
+        int Index = 0;
+        for (FHexRingIterator It(Center, Ring); It; ++It, ++Index)
+        {
+            const float Angle = Index * SliceSize;
+            if (Shadows.IsBlocked(Angle))
+            {
+                continue;
+            }
+
+            FHexMapCoord Coord = HexMath::AxialToOffset(*It);
+            bool IsBlocking = true;
+            if (Coord.IsValid(Width, Height))
+            {
+                const int CellIndex = Coord.x + Coord.y * Width;
+                OutVisible[CellIndex] = true;
+                IsBlocking = EHexCellFlags::BlocksSight(CellFlags[CellIndex]);
+            }
+
+            if (IsBlocking)
+            {
+                //Widened slightly so neighbouring blockers leave no gaps from float error
+                const float HalfWidth = SliceSize * 0.5f + KINDA_SMALL_NUMBER;
+                NewShadows.Emplace(Angle - HalfWidth, Angle + HalfWidth);
+            }
+        }
+
+        for (const auto& Shadow : NewShadows)
+        {
+            Shadows.Add(Shadow.X, Shadow.Y);
+        }
+    }
+}
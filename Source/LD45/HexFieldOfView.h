@@ -0,0 +1,11 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Util.h"
+
+/**
+ * Ring based shadowcasting over a packed EHexCellFlags grid.
+ * Each ring is split into equal angular slices, a visible blocking cell shadows its slice for every ring beyond it.
+ * Blocking cells are themselves visible, OutVisible is indexed x + y * Width.
+ */
+LD45_API void ComputeHexFieldOfView(const TArray<uint8>& CellFlags, int Width, int Height, const FHexMapCoord& Source, int Radius, TBitArray<>& OutVisible);
@@ -0,0 +1,63 @@
+#include "HexInfluenceMap.h"
+#include "HexMath.h"
+
+void FHexInfluenceMap::Init(int InWidth, int InHeight)
+{
+    Width = InWidth;
+    Height = InHeight;
+    Values.Init(0.0f, Width * Height);
+}
+
+void FHexInfluenceMap::Reset()
+{
+    FMemory::Memzero(Values.GetData(), Values.Num() * sizeof(float));
+}
+
+void FHexInfluenceMap::Stamp(const FHexMapCoord& Center, float Strength, int Radius)
+{
+    const float Falloff = 1.0f / float(Radius + 1);
+    for (FHexSpiralIterator It(HexMath::OffsetToAxial(Center), Radius); It; ++It)
+    {
+        Add(HexMath::AxialToOffset(*It), Strength * (1.0f - It.GetRadius() * Falloff));
+    }
+}
+
+void FHexInfluenceMap::Blur(FHexInfluenceMap& Out, int Passes) const
+{
+    if (Out.Width != Width || Out.Height != Height)
+    {
+        Out.Init(Width, Height);
+    }
+    Out.Values = Values;
+
+    //Opposite direction pairs from GetDirectionsAt: E/W, NE/SW, NW/SE
+    static const int Axes[3][2] = { {1, 4}, {0, 3}, {5, 2} };
+
+    TArray<float> Scratch;
+    Scratch.SetNumUninitialized(Values.Num());
+
+    for (int Pass = 0; Pass < Passes; Pass++)
+    {
+        for (const auto& Axis : Axes)
+        {
+            for (int y = 0; y < Height; y++)
+            {
+                const auto& Directions = GetDirectionsAt(FHexMapCoord(0, y));
+                const FHexMapCoord& DirA = Directions[Axis[0]];
+                const FHexMapCoord& DirB = Directions[Axis[1]];
+                for (int x = 0; x < Width; x++)
+                {
+                    const FHexMapCoord Coord(x, y);
+                    const float Center = Out.Values[x + y * Width];
+                    const FHexMapCoord A = Coord + DirA;
+                    const FHexMapCoord B = Coord + DirB;
+                    //Edges reuse the centre value so influence doesn't leak off the map
+                    const float ValueA = A.IsValid(Width, Height) ? Out.Values[A.x + A.y * Width] : Center;
+                    const float ValueB = B.IsValid(Width, Height) ? Out.Values[B.x + B.y * Width] : Center;
+                    Scratch[x + y * Width] = Center * 0.5f + (ValueA + ValueB) * 0.25f;
+                }
+            }
+            Exchange(Scratch, Out.Values);
+        }
+    }
+}
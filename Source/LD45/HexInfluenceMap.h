@@ -0,0 +1,35 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Util.h"
+
+/**
+ * Flat float grid over the map, indexed x + y * Width
+ */
+struct LD45_API FHexInfluenceMap
+{
+public:
+
+    void Init(int InWidth, int InHeight);
+
+    void Reset();
+
+    FORCEINLINE bool IsValid(const FHexMapCoord& Coord) const { return Coord.IsValid(Width, Height); }
+
+    FORCEINLINE float Get(const FHexMapCoord& Coord) const { return IsValid(Coord) ? Values[Coord.x + Coord.y * Width] : 0.0f; }
+
+    FORCEINLINE void Add(const FHexMapCoord& Coord, float Value) { if (IsValid(Coord)) { Values[Coord.x + Coord.y * Width] += Value; } }
+
+    //Adds Strength at Center falling off linearly to zero just past Radius, pass a negative Strength to remove a stamp
+    void Stamp(const FHexMapCoord& Center, float Strength, int Radius);
+
+    //Three 1D [1/4 1/2 1/4] passes, one per hex axis, written into Out
+    void Blur(FHexInfluenceMap& Out, int Passes = 1) const;
+
+public:
+
+    int Width = 0;
+    int Height = 0;
+
+    TArray<float> Values;
+};
@@ -12,6 +12,15 @@
 #include "Engine/World.h"
 #include "VoidGameMode.h"
 #include "Components/StaticMeshComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Paper2DModule.h"
+#include "HexMath.h"
+#include "HexFieldOfView.h"
+#include "HexBitboard.h"
+#include "HexMapData.h"
+#include "HexAnimationScheduler.h"
+#include "LD45Stats.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogHexMap, Log, All)
 
@@ -20,6 +29,7 @@ AHexMap::AHexMap()
 {
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.bStartWithTickEnabled = false; //Only while there's work and no animation scheduler to do it, or for streaming
 
     MinCellTransitionDuration = 0.5f;
     MaxCellTransitionDuration = 1.0f;
@@ -28,6 +38,27 @@ AHexMap::AHexMap()
     IsTransitioningIn = true;
 
     CellTransitionTick = 0.0f;
+
+    AttractionRadius = 24;
+    HighValueAttraction = 2.0f;
+    AttractionWeight = 1.0f;
+    ThreatWeight = 0.25f;
+    DangerWeight = 2.0f;
+
+    UseChunkedCells = false;
+    ChunkSize = 16;
+    CameraChunkRadius = 2;
+    EntityChunkRadius = 1;
+    ChunkEvictHysteresis = 2;
+    StreamingInterval = 0.25f;
+
+    UseFlatHierarchy = false;
+    DisableCellCollision = false;
+
+    for (auto& IsDirty : IsInfluenceDirty)
+    {
+        IsDirty = true;
+    }
 }
 
 void AHexMap::OnConstruction(const FTransform& Transform)
@@ -38,12 +69,98 @@ void AHexMap::OnConstruction(const FTransform& Transform)
 void AHexMap::BeginPlay()
 {
 	Super::BeginPlay();
+
+    //Nothing is attached to carry flat cells along when the map moves
+    if (USceneComponent* Root = GetRootComponent())
+    {
+        Root->TransformUpdated.AddUObject(this, &AHexMap::HandleTransformUpdated);
+    }
+
+    SetActorTickEnabled(UseChunkedCells || HasAnimationWork());
 }
 
 void AHexMap::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+    if (!IsAnimationScheduled())
+    {
+        UpdateAnimation(DeltaTime);
+    }
+
+    if (UseChunkedCells && CellTransitions.Num() == 0)
+    {
+        StreamingTimer -= DeltaTime;
+        if (StreamingTimer <= 0.0f)
+        {
+            StreamingTimer = StreamingInterval;
+            UpdateStreaming();
+        }
+    }
+
+    if (!UseChunkedCells && (IsAnimationScheduled() || !HasAnimationWork()))
+    {
+        SetActorTickEnabled(false);
+    }
+}
+
+void AHexMap::ScheduleAnimation()
+{
+    if (IsAnimationScheduled() || !HasAnimationWork())
+    {
+        return;
+    }
+
+    if (auto Scheduler = UHexAnimationScheduler::GetAnimationScheduler(this))
+    {
+        AnimationScheduler = Scheduler;
+        ScheduledAnimationId = Scheduler->Play(this, [this](float DeltaTime)
+        {
+            return UpdateAnimation(DeltaTime);
+        });
+    }
+    else
+    {
+        ScheduledAnimationId = INDEX_NONE;
+        SetActorTickEnabled(true);
+    }
+}
+
+bool AHexMap::IsAnimationScheduled() const
+{
+    return ScheduledAnimationId != INDEX_NONE && AnimationScheduler.IsValid() && AnimationScheduler->IsActive(ScheduledAnimationId);
+}
+
+bool AHexMap::UpdateAnimation(float DeltaTime)
+{
+    AdvanceTransition(DeltaTime);
+    FlushCellTransforms();
+    return HasAnimationWork();
+}
+
+void AHexMap::HandleTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+    if (UseFlatHierarchy)
+    {
+        for (int Index = 0; Index < Cells.Num(); Index++)
+        {
+            MarkCellTransformDirty(Index);
+        }
+    }
+}
+
+void AHexMap::FinishTransitions()
+{
+    //A pending refresh chains a transition in after the one out, so keep going until idle
+    while (CellTransitions.Num() > 0)
+    {
+        AdvanceTransition(MaxCellTransitionDuration);
+    }
+    FlushCellTransforms();
+}
+
+void AHexMap::AdvanceTransition(float DeltaTime)
+{
     if (CellTransitions.Num() > 0)
     {
         CellTransitionTick += DeltaTime;
@@ -76,23 +193,101 @@ bool AHexMap::SetTileMap(UPaperTileMap* NewTileMap)
     if (auto MapComponent = GetRenderComponent())
     {
         MapComponent->SetTileMap(NewTileMap);
+        MapData = nullptr;
+        HasGeneratedSeed = false;
+        RequestRefresh();
+        return true;
+    }
+    return false;
+}
+
+bool AHexMap::SetMapData(UHexMapData* NewMapData)
+{
+    if (NewMapData && NewMapData->IsValid())
+    {
+        MapData = NewMapData;
+        HasGeneratedSeed = false;
+        RequestRefresh();
+        return true;
+    }
+    return false;
+}
 
-        if (Cells.Num() == 0)
+bool AHexMap::GenerateMap(int Seed)
+{
+    //Sample the current layout so generated cells line up with authored ones
+    const FHexLayoutBasis Basis = ReadLayoutBasis();
+
+    FHexMapGeneratorSettings Settings = GeneratorSettings;
+    Settings.Seed = Seed;
+    if (SetMapData(FHexMapGenerator::Generate(Settings, Basis, this)))
+    {
+        HasGeneratedSeed = true;
+        GeneratedSeed = Seed;
+        return true;
+    }
+    return false;
+}
+
+static const TCHAR* GeneratedMapIdPrefix = TEXT("Generated:");
+
+FString AHexMap::GetMapId() const
+{
+    if (HasGeneratedSeed)
+    {
+        return FString::Printf(TEXT("%s%d"), GeneratedMapIdPrefix, GeneratedSeed);
+    }
+    if (MapData)
+    {
+        return MapData->GetPathName();
+    }
+    auto MapComponent = GetRenderComponent();
+    return MapComponent && MapComponent->TileMap ? MapComponent->TileMap->GetPathName() : FString();
+}
+
+bool AHexMap::SetMapId(const FString& MapId)
+{
+    bool IsSet = false;
+    if (MapId.StartsWith(GeneratedMapIdPrefix))
+    {
+        IsSet = GenerateMap(FCString::Atoi(*MapId + FCString::Strlen(GeneratedMapIdPrefix)));
+    }
+    else if (UObject* Asset = MapId.IsEmpty() ? nullptr : StaticLoadObject(UObject::StaticClass(), nullptr, *MapId))
+    {
+        if (auto NewMapData = Cast<UHexMapData>(Asset))
         {
-            RefreshCells();
+            IsSet = SetMapData(NewMapData);
         }
-        else
+        else if (auto NewTileMap = Cast<UPaperTileMap>(Asset))
         {
-            IsPendingRefresh = true;
-            StartTransition(false);
+            IsSet = SetTileMap(NewTileMap);
         }
-        return true;
     }
-    return false;
+
+    if (IsSet)
+    {
+        FinishTransitions();
+    }
+    return IsSet;
+}
+
+void AHexMap::RequestRefresh()
+{
+    if (Cells.Num() == 0)
+    {
+        RefreshCells();
+    }
+    else
+    {
+        IsPendingRefresh = true;
+        StartTransition(false);
+    }
 }
 
 void AHexMap::RefreshCells()
 {
+    LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_RefreshCells);
+
     //If we're currently transitioning then mark pending
     if (CellTransitions.Num() > 0)
     {
@@ -103,20 +298,90 @@ void AHexMap::RefreshCells()
     //Cleanup up existing cells
     for (const auto& Cell : Cells)
     {
-        if (Cell->IsValidLowLevelFast())
+        if (Cell && Cell->IsValidLowLevelFast())
         {
             Cell->Destroy();
         }
     }
     Cells.Empty();
+    CellFlags.Empty();
+    CellHeightOffsets.Empty();
+    AttackOverlayCounts.Empty();
+    DirtyCellTransforms.Empty();
+    CellTypes.Empty();
+    CellTypeNames.Empty();
+    CellTypeClasses.Empty();
+    LoadedChunks.Empty();
+    FieldOfViewCache.Empty();
     CellsWidth = CellsHeight = 0;
+    MarkBoardChanged();
+    ResetHighlightLayers();
+
+    //Packed grid first, actors are spawned from it
+    LoadedMapData = MapData && MapData->IsValid() ? MapData : nullptr;
+    if (LoadedMapData)
+    {
+        ReadMapDataCellTypes();
+    }
+    else
+    {
+        ReadTileMapCellTypes();
+    }
+
+    LayoutBasis = ReadLayoutBasis();
+
+    Cells.SetNumZeroed(CellTypes.Num());
+    CellFlags.SetNumZeroed(CellTypes.Num());
+    CellHeightOffsets.SetNumZeroed(CellTypes.Num());
+    AttackOverlayCounts.SetNumZeroed(CellTypes.Num());
+    DirtyCellTransforms.Init(false, CellTypes.Num());
+    AnyCellTransformDirty = false;
+    for (auto& Board : FlagBoards)
+    {
+        Board.Init(CellsWidth, CellsHeight);
+    }
+    for (int Index = 0; Index < CellTypes.Num(); Index++)
+    {
+        if (CellTypes[Index] != 0)
+        {
+            SetCellFlags(Index, ReadCellFlags(CellTypeClasses[CellTypes[Index] - 1]->GetDefaultObject<AHexCell>()));
+        }
+    }
+
+    ResetHighlightLayers();
+    ResetInfluence();
+
+    if (UseChunkedCells)
+    {
+        ChunkSize = FMath::Max(ChunkSize, 1);
+        ChunksWide = FMath::DivideAndRoundUp(CellsWidth, ChunkSize);
+        ChunksHigh = FMath::DivideAndRoundUp(CellsHeight, ChunkSize);
+        LoadedChunks.Init(false, ChunksWide * ChunksHigh);
+        UpdateStreaming();
+    }
+    else
+    {
+        for (int Index = 0; Index < Cells.Num(); Index++)
+        {
+            SpawnCell(Index);
+        }
+    }
+
+    StartTransition(true);
+
+    PostLoadCells();
+
+    IsPendingRefresh = false;
+}
 
-    //Generate new ones
+void AHexMap::ReadTileMapCellTypes()
+{
     auto MapComponent = GetRenderComponent();
     if (MapComponent && MapComponent->TileMap && TileDataTable)
     {
         int NumLayers;
         MapComponent->GetMapSize(CellsWidth, CellsHeight, NumLayers);
+        CellTypes.Reserve(CellsWidth * CellsHeight);
 
         for (int y = 0; y < CellsHeight; y++)
         {
@@ -124,248 +389,1065 @@ void AHexMap::RefreshCells()
             {
                 auto TileInfo = MapComponent->GetTile(x, y, 0);
 
-                AHexCell* NewCell = nullptr;
-
+                uint8 CellType = 0;
                 if (TileInfo.TileSet)
                 {
                     auto TileMetaData = TileInfo.TileSet->GetTileMetadata(TileInfo.GetTileIndex());
                     if (ensureMsgf(TileMetaData && TileMetaData->HasMetaData(), TEXT("No meta data for index %d"), TileInfo.GetTileIndex()))
                     {
-                        FName TileType = TileMetaData->UserDataName;
-                        FString Context = FString::Format(TEXT("Tile_({0},{1})"), { x,y });
-                        if (auto TileData = TileDataTable->FindRow<FHexTileTypeData>(TileType, Context))
-                        {
-                            if (ensureMsgf(TileData->CellActorClass, TEXT("No cell class set for tile: %s"), *TileType.ToString()))
-                            {
-                                FVector TileLocation = MapComponent->GetTileCenterPosition(x, y, 0, true);
-                                FActorSpawnParameters SpawnParams;
-                                SpawnParams.Owner = this;
-                                SpawnParams.Name = FName(*Context);
-                                NewCell = GetWorld()->SpawnActor<AHexCell>(TileData->CellActorClass, TileLocation, FRotator::ZeroRotator, SpawnParams);
-                                if (NewCell)
-                                {
-                                    NewCell->SetMapCoord({ x,y });
-                                    NewCell->AttachToActor(this, FAttachmentTransformRules::KeepWorldTransform);
-                                }
-                            }
-                        }
+                        CellType = FindOrAddCellType(TileMetaData->UserDataName);
                     }
                 }
-
-                Cells.Add(NewCell);
+                CellTypes.Add(CellType);
             }
         }
     }
-
-    StartTransition(true);
-
-    PostLoadCells();
-
-    IsPendingRefresh = false;
 }
 
-void AHexMap::HighlightCells(const TArray<FHexMapCoord>& CellsToHighlight, FColor Color)
+void AHexMap::ReadMapDataCellTypes()
 {
-    for (const auto& Location : CellsToHighlight)
+    CellsWidth = LoadedMapData->Width;
+    CellsHeight = LoadedMapData->Height;
+
+    //Baked indices only need translating if our palette orders the types differently
+    TArray<uint8, TInlineAllocator<32>> Remap;
+    Remap.Add(0);
+    bool IsIdentity = true;
+    for (FName TileType : LoadedMapData->CellTypeNames)
     {
-        if (auto Cell = GetCell(Location.x, Location.y))
-        {
-            Cell->HighlightCell(Color);
-        }
+        Remap.Add(FindOrAddCellType(TileType));
+        IsIdentity &= Remap.Last() == Remap.Num() - 1;
     }
-}
 
-void AHexMap::UnhighlightAllCells()
-{
-    for (auto Cell : Cells)
+    if (IsIdentity)
     {
-        Cell->UnhighlightCell();
+        CellTypes = LoadedMapData->CellTypes;
     }
-}
-
-TArray<FHexMapCoord> AHexMap::GetValidPlayerSpawnLocations() const
-{
-    TArray<FHexMapCoord> Result;
-    Result.Reserve(PlayerSpawnLocations.Num());
-
-    for (const auto& Location : PlayerSpawnLocations)
+    else
     {
-        if (IsTraversable(Location))
+        //UHexMapData::IsValid has checked every byte is within the palette
+        CellTypes.SetNumUninitialized(LoadedMapData->CellTypes.Num());
+        for (int Index = 0; Index < CellTypes.Num(); Index++)
         {
-            Result.Emplace(Location);
+            CellTypes[Index] = Remap[LoadedMapData->CellTypes[Index]];
         }
     }
-
-    return Result;
 }
 
-TArray<FHexMapCoord> AHexMap::GetValidEnemySpawnLocations() const
+uint8 AHexMap::FindOrAddCellType(FName TileType)
 {
-    TArray<FHexMapCoord> Result;
-    Result.Reserve(EnemySpawnLocations.Num());
-
-    for (const auto& Location : EnemySpawnLocations)
+    int Index = CellTypeNames.IndexOfByKey(TileType);
+    if (Index == INDEX_NONE)
     {
-        if (IsTraversable(Location))
+        auto TileData = TileDataTable ? TileDataTable->FindRow<FHexTileTypeData>(TileType, TEXT("FindOrAddCellType")) : nullptr;
+        if (!ensureMsgf(TileData && TileData->CellActorClass, TEXT("No cell class set for tile: %s"), *TileType.ToString()))
+        {
+            return 0;
+        }
+        if (!ensureMsgf(CellTypeNames.Num() < MAX_uint8, TEXT("Too many tile types, %s dropped"), *TileType.ToString()))
         {
-            Result.Emplace(Location);
+            return 0;
         }
+        CellTypeClasses.Add(TileData->CellActorClass);
+        Index = CellTypeNames.Add(TileType);
     }
-
-    return Result;
+    return uint8(Index + 1); //0 is no cell
 }
 
-void AHexMap::GetAdjacentHexCoords(const FHexMapCoord& Coord, TArray<FHexMapCoord>& OutAdjacent) const
+FVector AHexMap::GetCellWorldLocation(const FHexMapCoord& Coord) const
 {
-    const auto& Directions = GetDirectionsAt(Coord);
-    for (const auto& Direction : Directions)
+    if (auto MapComponent = GetRenderComponent())
     {
-        FHexMapCoord AdjacentCoord = Coord + Direction;
-        if (AdjacentCoord.IsValid(CellsWidth, CellsHeight))
+        if (LoadedMapData && LoadedMapData->CellPositions.Num() == CellTypes.Num())
         {
-            OutAdjacent.Emplace(AdjacentCoord);
+            return MapComponent->GetComponentTransform().TransformPosition(LoadedMapData->CellPositions[GetCellIndex(Coord)]);
         }
+        return MapComponent->GetTileCenterPosition(Coord.x, Coord.y, 0, true);
     }
+    return GetActorLocation();
 }
 
-bool AHexMap::GetNextCoordInDirection(const FHexMapCoord& Coord, int Direction, FHexMapCoord& OutCoord) const
+FHexLayoutBasis AHexMap::ReadLayoutBasis() const
 {
-    const auto& Directions = GetDirectionsAt(Coord);
-    if(Direction >= 0 && Direction < Directions.Num())
+    FHexLayoutBasis Basis;
+    if (LoadedMapData && LoadedMapData->CellPositions.Num() == CellTypes.Num() && CellsWidth > 1 && CellsHeight > 2)
     {
-        FHexMapCoord NextCoord = Coord + Directions[Direction];
-        if (NextCoord.IsValid(CellsWidth, CellsHeight))
+        const auto& Positions = LoadedMapData->CellPositions;
+        Basis.Origin = Positions[0];
+        Basis.ColumnStep = Positions[1] - Basis.Origin;
+        Basis.OddRowOffset = Positions[CellsWidth] - Basis.Origin;
+        Basis.RowPairStep = Positions[CellsWidth * 2] - Basis.Origin;
+    }
+    else if (auto MapComponent = GetRenderComponent())
+    {
+        if (const UPaperTileMap* TileMap = MapComponent->TileMap)
         {
-            OutCoord = NextCoord;
-            return true;
+            Basis.Origin = TileMap->GetTileCenterInLocalSpace(0, 0);
+            Basis.ColumnStep = TileMap->GetTileCenterInLocalSpace(1, 0) - Basis.Origin;
+            Basis.OddRowOffset = TileMap->GetTileCenterInLocalSpace(0, 1) - Basis.Origin;
+            Basis.RowPairStep = TileMap->GetTileCenterInLocalSpace(0, 2) - Basis.Origin;
         }
     }
-    return false;
+    return Basis;
 }
 
-AHexCell* AHexMap::GetCell(int x, int y) const
+bool AHexMap::GetCoordFromWorldRay(const FVector& RayOrigin, const FVector& RayDirection, FHexMapCoord& OutCoord) const
 {
-    if (x >= 0 && x < CellsWidth && y >= 0 && y < CellsHeight)
+    return IntersectMapPlane(RayOrigin, RayDirection, OutCoord) && OutCoord.IsValid(CellsWidth, CellsHeight);
+}
+
+bool AHexMap::IntersectMapPlane(const FVector& RayOrigin, const FVector& RayDirection, FHexMapCoord& OutCoord) const
+{
+    auto MapComponent = GetRenderComponent();
+    if (!MapComponent || CellsWidth == 0)
     {
-        int Index = x + (y * CellsWidth);
-        return ensure(Cells.IsValidIndex(Index)) ? Cells[Index] : nullptr;
+        return false;
     }
-    return nullptr;
+
+    const FTransform& MapTransform = MapComponent->GetComponentTransform();
+    const FPlane MapPlane(MapTransform.GetLocation(), MapTransform.TransformVectorNoScale(PaperAxisZ));
+    if (FMath::IsNearlyZero(FVector::DotProduct(RayDirection, MapPlane)))
+    {
+        return false;
+    }
+    const FVector Hit = FMath::LinePlaneIntersection(RayOrigin, RayOrigin + RayDirection, MapPlane);
+
+    OutCoord = LayoutBasis.GetCoord(MapTransform.InverseTransformPosition(Hit));
+    return true;
+}
+
+AHexCell* AHexMap::GetCellFromWorldRay(const FVector& RayOrigin, const FVector& RayDirection) const
+{
+    FHexMapCoord Coord;
+    return GetCoordFromWorldRay(RayOrigin, RayDirection, Coord) ? GetCell(Coord.x, Coord.y) : nullptr;
 }
 
-bool AHexMap::IsTraversable(const FHexMapCoord& Coord, class AMapEntity* Entity) const
+AHexCell* AHexMap::GetCellUnderCursor(APlayerController* PlayerController) const
 {
-    if (AHexCell* Cell = GetCell(Coord.x, Coord.y))
+    FVector RayOrigin, RayDirection;
+    if (PlayerController && PlayerController->DeprojectMousePositionToWorld(RayOrigin, RayDirection))
     {
-        if (Cell->GetIsTraversable())
-        {
-            return true;
-        }
+        return GetCellFromWorldRay(RayOrigin, RayDirection);
     }
-    return false;
+    return nullptr;
 }
 
-void AHexMap::StartTransition(bool TransitionIn)
+AHexCell* AHexMap::SpawnCell(int Index)
 {
-    if (CellTransitions.Num() > 0)
+    if (!CellTypes.IsValidIndex(Index) || CellTypes[Index] == 0 || Cells[Index])
     {
-        UE_LOG(LogHexMap, Warning, TEXT("Failed to start transition, already running!"));
-        return;
+        return Cells.IsValidIndex(Index) ? Cells[Index] : nullptr;
     }
 
-    IsTransitioningIn = TransitionIn;
+    const FHexMapCoord Coord(Index % CellsWidth, Index / CellsWidth);
+    FActorSpawnParameters SpawnParams;
+    SpawnParams.Owner = this;
+    SpawnParams.Name = FName(*FString::Format(TEXT("Tile_({0},{1})"), { Coord.x, Coord.y }));
 
-    //TODO: Support other transition types....
-    //this->TransitionType
+    FVector Location = GetCellWorldLocation(Coord);
+    if (UseFlatHierarchy)
+    {
+        Location.Z += CellHeightOffsets[Index];
+    }
 
-    for (auto Cell : Cells)
+    AHexCell* NewCell = GetWorld()->SpawnActor<AHexCell>(CellTypeClasses[CellTypes[Index] - 1], Location, FRotator::ZeroRotator, SpawnParams);
+    if (NewCell)
     {
-        if (Cell)
+        NewCell->SetMapCoord(Coord);
+        if (DisableCellCollision)
         {
-            FCellTransition Transition;
-            Transition.Cell = Cell;
-            Transition.Duration = FMath::RandRange(MinCellTransitionDuration, MaxCellTransitionDuration);
-            Transition.OriginHeight = Cell->GetActorLocation().Z;
-            CellTransitions.Add(Transition);
+            NewCell->SetActorEnableCollision(false);
         }
-    }
-
-    CellTransitionTick = 0.0f;
-    UpdateCellTransitions();
-}
+        if (!UseFlatHierarchy)
+        {
+            NewCell->AttachToActor(this, FAttachmentTransformRules::KeepWorldTransform);
+        }
+        Cells[Index] = NewCell;
 
-bool AHexMap::UpdateCellTransitions()
-{
-    bool IsAnimating = false;
-    for (const auto& Transition : CellTransitions)
-    {
-        if (auto Cell = Transition.Cell.Get())
+        //Blueprint construction may have changed the terrain from the class defaults
+        const uint8 Flags = ReadCellFlags(NewCell) | (CellFlags[Index] & (EHexCellFlags::Occupied | EHexCellFlags::Friendly));
+        if (Flags != CellFlags[Index])
         {
-            float tval = FMath::Clamp(CellTransitionTick / Transition.Duration, 0.0f, 1.0f);
-            tval = IsTransitioningIn ? tval : 1.0f - tval;
+            SetCellFlags(Index, Flags);
+            MarkBoardChanged();
+        }
 
-            float HeightOffset = tval * -200.0f;
-            if (TransitionCurve)
+        //Streamed in cells pick up whatever was highlighted while they were away
+        for (int Channel = 0; Channel < (int)EHexHighlightChannel::Count; Channel++)
+        {
+            if (HighlightLayers[Channel].Mask[Index])
             {
-                HeightOffset = TransitionCurve->GetFloatValue(tval);
+                SetCellHighlightState(Index, (EHexHighlightChannel)Channel, true);
             }
-            auto Location = Cell->GetActorLocation();
-            Location.Z = Transition.OriginHeight + HeightOffset;
-            Cell->SetActorLocation(Location);
-            IsAnimating |= CellTransitionTick < Transition.Duration;
         }
+        INC_DWORD_STAT(STAT_LD45_CellsTouched);
     }
-    return !IsAnimating;
+    return NewCell;
 }
 
-void AHexMap::PostLoadCells()
+void AHexMap::MarkCellTransformDirty(int Index)
 {
-    //TODO: read from layers
-    EnemySpawnLocations.Reset();
-    if (auto TiledMap = GetRenderComponent())
+    if (UseFlatHierarchy && DirtyCellTransforms.IsValidIndex(Index))
     {
-        int Width, Height, NumLayers;
-        TiledMap->GetMapSize(Width, Height, NumLayers);
-
-        for (int ox = 0; ox < Width && ox < 4; ox++)
+        DirtyCellTransforms[Index] = true;
+        if (!AnyCellTransformDirty)
         {
-            for (int oy = 0; oy < Height; oy++)
-            {
-                EnemySpawnLocations.Emplace(ox, oy);
-            }
+            AnyCellTransformDirty = true;
+            ScheduleAnimation();
         }
     }
+}
 
-    //TODO: read from layers
-    PlayerSpawnLocations.Reset();
-    if (auto TiledMap = GetRenderComponent())
+void AHexMap::FlushCellTransforms()
+{
+    if (!AnyCellTransformDirty)
     {
-        int Width, Height, NumLayers;
-        TiledMap->GetMapSize(Width, Height, NumLayers);
+        return;
+    }
 
-        for (int ox = Width - 4; ox < Width; ox++)
+    LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_CellTransforms);
+
+    AnyCellTransformDirty = false;
+    for (TConstSetBitIterator<> It(DirtyCellTransforms); It; ++It)
+    {
+        const int Index = It.GetIndex();
+        if (AHexCell* Cell = Cells[Index])
         {
-            for (int oy = 0; oy < Height; oy++)
+            FVector Location = GetCellWorldLocation(FHexMapCoord(Index % CellsWidth, Index / CellsWidth));
+            Location.Z += CellHeightOffsets[Index];
+            Cell->SetActorLocation(Location, false, nullptr, ETeleportType::TeleportPhysics);
+
+            //Occupants sit where attachment would have snapped them
+            if (AMapEntity* Entity = Cell->GetOccupyingEntity())
             {
-                PlayerSpawnLocations.Emplace(ox, oy);
+                Entity->SetActorLocationAndRotation(Location, Cell->GetActorQuat(), false, nullptr, ETeleportType::TeleportPhysics);
             }
+            INC_DWORD_STAT(STAT_LD45_CellsTouched);
         }
     }
+    DirtyCellTransforms.Init(false, DirtyCellTransforms.Num());
+}
 
-    //TODO: read from layers
-    BuildingSpawnLocations.Reset();
-    if (auto TiledMap = GetRenderComponent())
+int AHexMap::GetChunkIndex(const FHexMapCoord& Coord) const
+{
+    return (Coord.x / ChunkSize) + (Coord.y / ChunkSize) * ChunksWide;
+}
+
+void AHexMap::LoadChunk(int ChunkIndex)
+{
+    if (!LoadedChunks.IsValidIndex(ChunkIndex) || LoadedChunks[ChunkIndex])
     {
-        int Width, Height, NumLayers;
-        TiledMap->GetMapSize(Width, Height, NumLayers);
+        return;
+    }
+    LoadedChunks[ChunkIndex] = true;
 
-        for (int ox = Width - 5; ox < Width; ox++)
+    const int MinX = (ChunkIndex % ChunksWide) * ChunkSize;
+    const int MinY = (ChunkIndex / ChunksWide) * ChunkSize;
+    for (int y = MinY; y < FMath::Min(MinY + ChunkSize, CellsHeight); y++)
+    {
+        for (int x = MinX; x < FMath::Min(MinX + ChunkSize, CellsWidth); x++)
         {
-            for (int oy = 0; oy < Height; oy++)
-            {
-                BuildingSpawnLocations.Emplace(ox, oy);
+            SpawnCell(GetCellIndex({ x, y }));
+        }
+    }
+}
+
+bool AHexMap::TryEvictChunk(int ChunkIndex)
+{
+    const int MinX = (ChunkIndex % ChunksWide) * ChunkSize;
+    const int MinY = (ChunkIndex / ChunksWide) * ChunkSize;
+    const int MaxX = FMath::Min(MinX + ChunkSize, CellsWidth);
+    const int MaxY = FMath::Min(MinY + ChunkSize, CellsHeight);
+
+    //Entities hold on to their cell actor so occupied chunks stay resident
+    for (int y = MinY; y < MaxY; y++)
+    {
+        for (int x = MinX; x < MaxX; x++)
+        {
+            if (CellFlags[GetCellIndex({ x, y })] & EHexCellFlags::Occupied)
+            {
+                return false;
+            }
+        }
+    }
+
+    for (int y = MinY; y < MaxY; y++)
+    {
+        for (int x = MinX; x < MaxX; x++)
+        {
+            AHexCell*& Cell = Cells[GetCellIndex({ x, y })];
+            if (Cell)
+            {
+                Cell->Destroy();
+                Cell = nullptr;
+            }
+        }
+    }
+    LoadedChunks[ChunkIndex] = false;
+    return true;
+}
+
+bool AHexMap::GetCameraFocusCoord(FHexMapCoord& OutCoord) const
+{
+    APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+    if (!PlayerController || !PlayerController->PlayerCameraManager)
+    {
+        return false;
+    }
+
+    //Where the view direction meets the map plane, clamped so looking past the edge still streams the nearest chunks
+    const FVector ViewLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+    const FVector ViewDirection = PlayerController->PlayerCameraManager->GetCameraRotation().Vector();
+    FHexMapCoord Coord;
+    if (!IntersectMapPlane(ViewLocation, ViewDirection, Coord))
+    {
+        return false;
+    }
+    OutCoord = FHexMapCoord(FMath::Clamp(Coord.x, 0, CellsWidth - 1), FMath::Clamp(Coord.y, 0, CellsHeight - 1));
+    return true;
+}
+
+void AHexMap::UpdateStreaming()
+{
+    if (!UseChunkedCells || LoadedChunks.Num() == 0)
+    {
+        return;
+    }
+
+    //Chunks are loaded inside the load radius and only evicted once outside the larger keep radius
+    TBitArray<> WantedChunks(false, LoadedChunks.Num());
+    TBitArray<> KeptChunks(false, LoadedChunks.Num());
+    auto MarkAround = [&](const FHexMapCoord& Coord, int LoadRadius)
+    {
+        const int ChunkX = Coord.x / ChunkSize;
+        const int ChunkY = Coord.y / ChunkSize;
+        const int KeepRadius = LoadRadius + ChunkEvictHysteresis;
+        for (int y = FMath::Max(ChunkY - KeepRadius, 0); y <= FMath::Min(ChunkY + KeepRadius, ChunksHigh - 1); y++)
+        {
+            for (int x = FMath::Max(ChunkX - KeepRadius, 0); x <= FMath::Min(ChunkX + KeepRadius, ChunksWide - 1); x++)
+            {
+                KeptChunks[x + y * ChunksWide] = true;
+                if (FMath::Abs(x - ChunkX) <= LoadRadius && FMath::Abs(y - ChunkY) <= LoadRadius)
+                {
+                    WantedChunks[x + y * ChunksWide] = true;
+                }
             }
         }
+    };
+
+    FHexMapCoord FocusCoord;
+    if (GetCameraFocusCoord(FocusCoord))
+    {
+        MarkAround(FocusCoord, CameraChunkRadius);
+    }
+
+    //The Occupied board skips empty words, so this scales with entities rather than cells
+    TTurnArray<FHexMapCoord> OccupiedCoords;
+    GetFlagBoard(EHexCellFlags::Occupied).GetCoords(OccupiedCoords);
+    TBitArray<> EntityChunks(false, LoadedChunks.Num());
+    for (const auto& Coord : OccupiedCoords)
+    {
+        //Entities sharing a chunk mark the same neighbourhood
+        FBitReference IsMarked = EntityChunks[GetChunkIndex(Coord)];
+        if (!IsMarked)
+        {
+            IsMarked = true;
+            MarkAround(Coord, EntityChunkRadius);
+        }
+    }
+
+    for (int ChunkIndex = 0; ChunkIndex < LoadedChunks.Num(); ChunkIndex++)
+    {
+        if (WantedChunks[ChunkIndex] && !LoadedChunks[ChunkIndex])
+        {
+            LoadChunk(ChunkIndex);
+        }
+        else if (!KeptChunks[ChunkIndex] && LoadedChunks[ChunkIndex])
+        {
+            TryEvictChunk(ChunkIndex);
+        }
+    }
+}
+
+void AHexMap::HighlightCells(const TArray<FHexMapCoord>& CellsToHighlight, FColor Color)
+{
+    //Older entry point, lights the Movement channel so the layers stay the record of what's lit
+    AddHighlightedCells(EHexHighlightChannel::Movement, CellsToHighlight, Color);
+}
+
+void AHexMap::UnhighlightAllCells()
+{
+    //Read from the layers, not the cells, a blueprint override of HighlightCell never sets the cell's flag.
+    //Cells lit on both channels are left to the Attack pass so each is only unhighlighted once
+    auto& MovementMask = HighlightLayers[(int)EHexHighlightChannel::Movement].Mask;
+    for (TConstSetBitIterator<> It(HighlightLayers[(int)EHexHighlightChannel::Attack].Mask); It; ++It)
+    {
+        MovementMask[It.GetIndex()] = false;
+    }
+    ClearHighlightChannel(EHexHighlightChannel::Movement);
+    ClearHighlightChannel(EHexHighlightChannel::Attack);
+
+    //Cells lit directly through AHexCell::HighlightCell aren't in any layer
+    for (auto Cell : Cells)
+    {
+        if (Cell && Cell->GetIsHighlighted())
+        {
+            Cell->UnhighlightCell();
+        }
+    }
+}
+
+void AHexMap::SetHighlightedCells(EHexHighlightChannel Channel, const TArray<FHexMapCoord>& Coords, FColor Color)
+{
+    TBitArray<> Mask(false, Cells.Num());
+    for (const auto& Coord : Coords)
+    {
+        if (Coord.IsValid(CellsWidth, CellsHeight))
+        {
+            Mask[GetCellIndex(Coord)] = true;
+        }
+    }
+    SetHighlightMask(Channel, Mask, Color);
+}
+
+void AHexMap::SetHighlightMask(EHexHighlightChannel Channel, const TBitArray<>& Mask, FColor Color)
+{
+    LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_Highlight);
+    auto& Layer = HighlightLayers[(int)Channel];
+    bool ColorChanged = Layer.Color != Color;
+    Layer.Color = Color;
+
+    for (int Index = 0; Index < Cells.Num(); Index++)
+    {
+        bool IsOn = Mask.IsValidIndex(Index) && Mask[Index];
+        if (IsOn != Layer.Mask[Index] || (IsOn && ColorChanged))
+        {
+            SetCellHighlightState(Index, Channel, IsOn);
+        }
+    }
+}
+
+void AHexMap::AddHighlightedCells(EHexHighlightChannel Channel, const TArray<FHexMapCoord>& Coords, FColor Color)
+{
+    auto& Layer = HighlightLayers[(int)Channel];
+    if (Layer.Color != Color)
+    {
+        //The layer has one colour, cells already lit take the new one too
+        Layer.Color = Color;
+        for (TConstSetBitIterator<> It(Layer.Mask); It; ++It)
+        {
+            SetCellHighlightState(It.GetIndex(), Channel, true);
+        }
+    }
+    for (const auto& Coord : Coords)
+    {
+        if (Coord.IsValid(CellsWidth, CellsHeight) && !Layer.Mask[GetCellIndex(Coord)])
+        {
+            SetCellHighlightState(GetCellIndex(Coord), Channel, true);
+        }
+    }
+}
+
+void AHexMap::RemoveHighlightedCells(EHexHighlightChannel Channel, const TArray<FHexMapCoord>& Coords)
+{
+    auto& Layer = HighlightLayers[(int)Channel];
+    for (const auto& Coord : Coords)
+    {
+        if (Coord.IsValid(CellsWidth, CellsHeight) && Layer.Mask[GetCellIndex(Coord)])
+        {
+            SetCellHighlightState(GetCellIndex(Coord), Channel, false);
+        }
+    }
+}
+
+void AHexMap::ClearHighlightChannel(EHexHighlightChannel Channel)
+{
+    auto& Layer = HighlightLayers[(int)Channel];
+    for (TConstSetBitIterator<> It(Layer.Mask); It; ++It)
+    {
+        SetCellHighlightState(It.GetIndex(), Channel, false);
+    }
+}
+
+void AHexMap::AddAttackOverlay(TArrayView<const FHexMapCoord> Coords)
+{
+    HighlightLayers[(int)EHexHighlightChannel::EnemyAttack].Color = FColor::Red;
+    for (const auto& Coord : Coords)
+    {
+        if (Coord.IsValid(CellsWidth, CellsHeight))
+        {
+            const int Index = GetCellIndex(Coord);
+            if (AttackOverlayCounts[Index]++ == 0)
+            {
+                SetCellHighlightState(Index, EHexHighlightChannel::EnemyAttack, true);
+            }
+        }
+    }
+}
+
+void AHexMap::RemoveAttackOverlay(TArrayView<const FHexMapCoord> Coords)
+{
+    for (const auto& Coord : Coords)
+    {
+        if (Coord.IsValid(CellsWidth, CellsHeight))
+        {
+            const int Index = GetCellIndex(Coord);
+            if (AttackOverlayCounts[Index] > 0 && --AttackOverlayCounts[Index] == 0)
+            {
+                SetCellHighlightState(Index, EHexHighlightChannel::EnemyAttack, false);
+            }
+        }
+    }
+}
+
+void AHexMap::ClearAttackOverlay()
+{
+    ClearHighlightChannel(EHexHighlightChannel::EnemyAttack);
+    FMemory::Memzero(AttackOverlayCounts.GetData(), AttackOverlayCounts.Num() * sizeof(uint16));
+}
+
+int AHexMap::GetAttackOverlayCount(const FHexMapCoord& Coord) const
+{
+    return Coord.IsValid(CellsWidth, CellsHeight) ? AttackOverlayCounts[GetCellIndex(Coord)] : 0;
+}
+
+bool AHexMap::IsCellHighlighted(EHexHighlightChannel Channel, const FHexMapCoord& Coord) const
+{
+    const auto& Layer = HighlightLayers[(int)Channel];
+    return Coord.IsValid(CellsWidth, CellsHeight) && Layer.Mask[GetCellIndex(Coord)];
+}
+
+void AHexMap::SetCellHighlightState(int Index, EHexHighlightChannel Channel, bool IsOn)
+{
+    HighlightLayers[(int)Channel].Mask[Index] = IsOn;
+
+    AHexCell* Cell = Cells[Index];
+    if (!Cell)
+    {
+        return;
+    }
+
+    switch (Channel)
+    {
+    case EHexHighlightChannel::Movement:
+    case EHexHighlightChannel::Attack:
+    {
+        //Attack wins over movement when both are lit
+        const auto& AttackLayer = HighlightLayers[(int)EHexHighlightChannel::Attack];
+        const auto& MovementLayer = HighlightLayers[(int)EHexHighlightChannel::Movement];
+        if (AttackLayer.Mask[Index])
+        {
+            Cell->HighlightCell(AttackLayer.Color);
+        }
+        else if (MovementLayer.Mask[Index])
+        {
+            Cell->HighlightCell(MovementLayer.Color);
+        }
+        else
+        {
+            Cell->UnhighlightCell();
+        }
+        break;
+    }
+    case EHexHighlightChannel::PendingSpawn:
+        Cell->ShowPendingSpawn(IsOn);
+        break;
+    case EHexHighlightChannel::EnemyAttack:
+        Cell->ShowEnemyAttack(IsOn);
+        break;
+    default:
+        break;
+    }
+
+    Cell->PlayHighlightFade();
+}
+
+void AHexMap::ResetHighlightLayers()
+{
+    for (auto& Layer : HighlightLayers)
+    {
+        Layer.Mask.Init(false, Cells.Num());
+    }
+}
+
+TArray<FHexMapCoord> AHexMap::GetValidPlayerSpawnLocations() const
+{
+    TTurnArray<FHexMapCoord> Locations;
+    GetValidSpawnLocations(PlayerSpawnBoard, Locations);
+    return TArray<FHexMapCoord>(Locations);
+}
+
+TArray<FHexMapCoord> AHexMap::GetValidEnemySpawnLocations() const
+{
+    TTurnArray<FHexMapCoord> Locations;
+    GetValidSpawnLocations(EnemySpawnBoard, Locations);
+    return TArray<FHexMapCoord>(Locations);
+}
+
+void AHexMap::GetValidSpawnLocations(const FHexBitboard& Zone, TTurnArray<FHexMapCoord>& OutLocations) const
+{
+    OutLocations.Reset();
+    if (Zone.Width != CellsWidth || Zone.Height != CellsHeight)
+    {
+        return; //Zones are rebuilt once the new cells are in
+    }
+    THexBitboard<FTurnArenaAllocator> Valid;
+    Valid.CopyFrom(Zone);
+    Valid.And(GetFlagBoard(EHexCellFlags::Traversable));
+    Valid.AndNot(GetFlagBoard(EHexCellFlags::Occupied));
+    Valid.GetCoords(OutLocations);
+}
+
+void AHexMap::GetAdjacentHexCoords(const FHexMapCoord& Coord, TArray<FHexMapCoord>& OutAdjacent) const
+{
+    const auto& Directions = GetDirectionsAt(Coord);
+    for (const auto& Direction : Directions)
+    {
+        FHexMapCoord AdjacentCoord = Coord + Direction;
+        if (AdjacentCoord.IsValid(CellsWidth, CellsHeight))
+        {
+            OutAdjacent.Emplace(AdjacentCoord);
+        }
+    }
+}
+
+bool AHexMap::GetNextCoordInDirection(const FHexMapCoord& Coord, int Direction, FHexMapCoord& OutCoord) const
+{
+    const auto& Directions = GetDirectionsAt(Coord);
+    if(Direction >= 0 && Direction < Directions.Num())
+    {
+        FHexMapCoord NextCoord = Coord + Directions[Direction];
+        if (NextCoord.IsValid(CellsWidth, CellsHeight))
+        {
+            OutCoord = NextCoord;
+            return true;
+        }
+    }
+    return false;
+}
+
+AHexCell* AHexMap::GetCell(int x, int y) const
+{
+    if (x >= 0 && x < CellsWidth && y >= 0 && y < CellsHeight)
+    {
+        int Index = x + (y * CellsWidth);
+        if (!ensure(Cells.IsValidIndex(Index)))
+        {
+            return nullptr;
+        }
+        return Cells[Index];
+    }
+    return nullptr;
+}
+
+AHexCell* AHexMap::GetOrLoadCell(int x, int y)
+{
+    if (x >= 0 && x < CellsWidth && y >= 0 && y < CellsHeight)
+    {
+        int Index = x + (y * CellsWidth);
+        if (!ensure(Cells.IsValidIndex(Index)))
+        {
+            return nullptr;
+        }
+        if (!Cells[Index] && UseChunkedCells && CellTypes[Index] != 0)
+        {
+            LoadChunk(GetChunkIndex({ x, y }));
+        }
+        return Cells[Index];
+    }
+    return nullptr;
+}
+
+int AHexMap::GetHexDistance(const FHexMapCoord& A, const FHexMapCoord& B)
+{
+    return HexMath::Distance(A, B);
+}
+
+void AHexMap::NotifyCellChanged(AHexCell* Cell)
+{
+    if (Cell && Cell->GetOwningMap() == this)
+    {
+        int Index = GetCellIndex(Cell->GetMapCoord());
+        if (CellFlags.IsValidIndex(Index))
+        {
+            SetCellFlags(Index, ReadCellFlags(Cell));
+        }
+    }
+    MarkBoardChanged();
+}
+
+void AHexMap::SetCellFlags(int Index, uint8 Flags)
+{
+    CellFlags[Index] = Flags;
+
+    const FHexMapCoord Coord(Index % CellsWidth, Index / CellsWidth);
+    for (int Bit = 0; Bit < NumFlagBoards; Bit++)
+    {
+        FlagBoards[Bit].Set(Coord, (Flags & (1 << Bit)) != 0);
+    }
+}
+
+const FHexBitboard& AHexMap::GetFlagBoard(uint8 Flag) const
+{
+    const int Bit = FMath::FloorLog2(Flag);
+    check(Flag == (1 << Bit) && Bit < NumFlagBoards);
+    return FlagBoards[Bit];
+}
+
+void AHexMap::GetZoneOfControl(bool Friendly, int Radius, FHexBitboard& OutZone) const
+{
+    FHexBitboard Sources = GetFlagBoard(EHexCellFlags::Occupied);
+    if (Friendly)
+    {
+        Sources.And(GetFlagBoard(EHexCellFlags::Friendly));
+    }
+    else
+    {
+        Sources.AndNot(GetFlagBoard(EHexCellFlags::Friendly));
+    }
+    HexBitboardQueries::ZoneOfControl(Sources, Radius, OutZone);
+}
+
+void AHexMap::GetAttackMask(const FHexBitboard& Sources, int Distance, FHexBitboard& OutMask) const
+{
+    HexBitboardQueries::AttackMask(Sources, Distance, GetFlagBoard(EHexCellFlags::Exists), GetFlagBoard(EHexCellFlags::Traversable), GetFlagBoard(EHexCellFlags::Occupied), OutMask);
+}
+
+uint8 AHexMap::ReadCellFlags(const AHexCell* Cell) const
+{
+    uint8 Flags = EHexCellFlags::None;
+    if (Cell)
+    {
+        Flags |= EHexCellFlags::Exists;
+        if (Cell->GetIsAttackable())
+        {
+            Flags |= EHexCellFlags::Traversable;
+        }
+        if (AMapEntity* Entity = Cell->GetOccupyingEntity())
+        {
+            Flags |= EHexCellFlags::Occupied;
+            if (Entity->GetIsFriendly())
+            {
+                Flags |= EHexCellFlags::Friendly;
+            }
+        }
+    }
+    return Flags;
+}
+
+TSharedRef<const TBitArray<>> AHexMap::GetFieldOfView(const FHexMapCoord& Source, int Radius)
+{
+    LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_FieldOfView);
+
+    const uint64 Key = uint64(Source.Pack()) | (uint64(uint32(Radius)) << 32);
+    if (auto Entry = FieldOfViewCache.Find(Key))
+    {
+        if (Entry->BoardVersion == BoardVersion)
+        {
+            return Entry->Visible;
+        }
+    }
+
+    //Stale entries can't become valid again so drop them all rather than growing forever
+    if (FieldOfViewCache.Num() > 1024)
+    {
+        FieldOfViewCache.Reset();
+    }
+
+    //Always a fresh array, a stale one may still be held by an earlier caller
+    TSharedRef<TBitArray<>> Visible = MakeShared<TBitArray<>>();
+    ComputeHexFieldOfView(CellFlags, CellsWidth, CellsHeight, Source, Radius, *Visible);
+    FieldOfViewCache.Add(Key, { Visible, BoardVersion });
+    INC_DWORD_STAT_BY(STAT_LD45_CellsTouched, HexMath::SpiralCount(Radius));
+    return Visible;
+}
+
+TArray<FHexMapCoord> AHexMap::GetVisibleCells(const FHexMapCoord& Source, int Radius)
+{
+    TArray<FHexMapCoord> Result;
+    const auto Visible = GetFieldOfView(Source, Radius);
+    for (TConstSetBitIterator<> It(*Visible); It; ++It)
+    {
+        Result.Emplace(It.GetIndex() % CellsWidth, It.GetIndex() / CellsWidth);
+    }
+    return Result;
+}
+
+bool AHexMap::HasLineOfSight(const FHexMapCoord& From, const FHexMapCoord& To)
+{
+    if (!From.IsValid(CellsWidth, CellsHeight) || !To.IsValid(CellsWidth, CellsHeight))
+    {
+        return false;
+    }
+    const auto Visible = GetFieldOfView(From, HexMath::Distance(From, To));
+    return (*Visible)[GetCellIndex(To)];
+}
+
+void AHexMap::UpdateEntityInfluence(AMapEntity* Entity)
+{
+    LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_Influence);
+
+    RemoveEntityInfluence(Entity);
+
+    AHexCell* Cell = Entity ? Entity->GetMapCell() : nullptr;
+    if (!Cell || Cell->GetOwningMap() != this || !Entity->GetIsFriendly())
+    {
+        return; //Only friendlies project presence, enemies only telegraph
+    }
+
+    auto& Stamps = PresenceStamps.Add(Entity);
+    const FHexMapCoord& Coord = Cell->GetMapCoord();
+    Stamps.Add({ EHexInfluenceLayer::Threat, Coord, 1.0f, Entity->GetAttackDistance() });
+    Stamps.Add({ EHexInfluenceLayer::Attraction, Coord, Entity->GetIsHighValue() ? HighValueAttraction : 1.0f, AttractionRadius });
+
+    for (const auto& Stamp : Stamps)
+    {
+        RawInfluence[(int)Stamp.Layer].Stamp(Stamp.Center, Stamp.Strength, Stamp.Radius);
+        IsInfluenceDirty[(int)Stamp.Layer] = true;
+    }
+}
+
+void AHexMap::RemoveEntityInfluence(AMapEntity* Entity)
+{
+    TArray<FInfluenceStamp, TInlineAllocator<2>> Stamps;
+    if (PresenceStamps.RemoveAndCopyValue(Entity, Stamps))
+    {
+        for (const auto& Stamp : Stamps)
+        {
+            RawInfluence[(int)Stamp.Layer].Stamp(Stamp.Center, -Stamp.Strength, Stamp.Radius);
+            IsInfluenceDirty[(int)Stamp.Layer] = true;
+        }
+    }
+    SetAttackInfluence(Entity, TArray<FHexMapCoord>());
+}
+
+void AHexMap::SetAttackInfluence(AMapEntity* Entity, const TArray<FHexMapCoord>& Locations)
+{
+    auto& Danger = RawInfluence[(int)EHexInfluenceLayer::Danger];
+
+    TArray<FHexMapCoord> Previous;
+    if (AttackStamps.RemoveAndCopyValue(Entity, Previous))
+    {
+        for (const auto& Coord : Previous)
+        {
+            Danger.Add(Coord, -1.0f);
+        }
+        IsInfluenceDirty[(int)EHexInfluenceLayer::Danger] = true;
+    }
+
+    if (Entity && Locations.Num() > 0)
+    {
+        for (const auto& Coord : Locations)
+        {
+            Danger.Add(Coord, 1.0f);
+        }
+        AttackStamps.Add(Entity, Locations);
+        IsInfluenceDirty[(int)EHexInfluenceLayer::Danger] = true;
+    }
+}
+
+float AHexMap::GetInfluence(EHexInfluenceLayer Layer, const FHexMapCoord& Coord)
+{
+    const int LayerIndex = (int)Layer;
+    if (IsInfluenceDirty[LayerIndex])
+    {
+        LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_Influence);
+        INC_DWORD_STAT_BY(STAT_LD45_CellsTouched, CellsWidth * CellsHeight);
+        //Danger is exact, only the broad layers are smoothed
+        RawInfluence[LayerIndex].Blur(BlurredInfluence[LayerIndex], Layer == EHexInfluenceLayer::Danger ? 0 : 1);
+        IsInfluenceDirty[LayerIndex] = false;
+    }
+    return BlurredInfluence[LayerIndex].Get(Coord);
+}
+
+float AHexMap::GetEnemyMoveScore(const FHexMapCoord& Coord)
+{
+    float Attraction = GetInfluence(EHexInfluenceLayer::Attraction, Coord);
+    if (Attraction <= 0.0f)
+    {
+        Attraction = GetDistantAttraction(Coord);
+    }
+
+    return AttractionWeight * Attraction
+        - ThreatWeight * GetInfluence(EHexInfluenceLayer::Threat, Coord)
+        - DangerWeight * GetInfluence(EHexInfluenceLayer::Danger, Coord);
+}
+
+float AHexMap::GetDistantAttraction(const FHexMapCoord& Coord) const
+{
+    int NearestDistance = MAX_int32;
+    for (const auto& Pair : PresenceStamps)
+    {
+        for (const auto& Stamp : Pair.Value)
+        {
+            if (Stamp.Layer == EHexInfluenceLayer::Attraction)
+            {
+                NearestDistance = FMath::Min(NearestDistance, HexMath::Distance(Coord, Stamp.Center));
+            }
+        }
+    }
+
+    if (NearestDistance == MAX_int32 || NearestDistance <= AttractionRadius)
+    {
+        return 0.0f; //Nothing to walk towards, or close enough for the layer itself
+    }
+    return -float(NearestDistance - AttractionRadius) / FMath::Max(AttractionRadius, 1);
+}
+
+void AHexMap::ResetInfluence()
+{
+    PresenceStamps.Reset();
+    AttackStamps.Reset();
+    for (int Layer = 0; Layer < (int)EHexInfluenceLayer::Count; Layer++)
+    {
+        RawInfluence[Layer].Init(CellsWidth, CellsHeight);
+        IsInfluenceDirty[Layer] = true;
+    }
+}
+
+bool AHexMap::IsTraversable(const FHexMapCoord& Coord, const class AMapEntity* Entity) const
+{
+    //Answered from the packed grid so streamed out cells don't need loading
+    if (Coord.IsValid(CellsWidth, CellsHeight))
+    {
+        const uint8 Flags = CellFlags[GetCellIndex(Coord)];
+        return (Flags & EHexCellFlags::Traversable) && !(Flags & EHexCellFlags::Occupied);
+    }
+    return false;
+}
+
+void AHexMap::StartTransition(bool TransitionIn)
+{
+    if (CellTransitions.Num() > 0)
+    {
+        UE_LOG(LogHexMap, Warning, TEXT("Failed to start transition, already running!"));
+        return;
+    }
+
+    IsTransitioningIn = TransitionIn;
+
+    //TODO: Support other transition types....
+    //this->TransitionType
+
+    for (auto Cell : Cells)
+    {
+        if (Cell)
+        {
+            FCellTransition Transition;
+            Transition.Cell = Cell;
+            Transition.Duration = FMath::RandRange(MinCellTransitionDuration, MaxCellTransitionDuration);
+            Transition.OriginHeight = UseFlatHierarchy ? CellHeightOffsets[GetCellIndex(Cell->GetMapCoord())] : Cell->GetActorLocation().Z;
+            CellTransitions.Add(Transition);
+        }
+    }
+
+    CellTransitionTick = 0.0f;
+    UpdateCellTransitions();
+    ScheduleAnimation();
+}
+
+bool AHexMap::UpdateCellTransitions()
+{
+    bool IsAnimating = false;
+    for (const auto& Transition : CellTransitions)
+    {
+        if (auto Cell = Transition.Cell.Get())
+        {
+            float tval = FMath::Clamp(CellTransitionTick / Transition.Duration, 0.0f, 1.0f);
+            tval = IsTransitioningIn ? tval : 1.0f - tval;
+
+            float HeightOffset = tval * -200.0f;
+            if (TransitionCurve)
+            {
+                HeightOffset = TransitionCurve->GetFloatValue(tval);
+            }
+            if (UseFlatHierarchy)
+            {
+                const int Index = GetCellIndex(Cell->GetMapCoord());
+                CellHeightOffsets[Index] = Transition.OriginHeight + HeightOffset;
+                MarkCellTransformDirty(Index);
+            }
+            else
+            {
+                auto Location = Cell->GetActorLocation();
+                Location.Z = Transition.OriginHeight + HeightOffset;
+                Cell->SetActorLocation(Location);
+            }
+            IsAnimating |= CellTransitionTick < Transition.Duration;
+        }
+    }
+    return !IsAnimating;
+}
+
+void AHexMap::PostLoadCells()
+{
+    if (LoadedMapData)
+    {
+        EnemySpawnLocations = LoadedMapData->EnemySpawnLocations;
+        PlayerSpawnLocations = LoadedMapData->PlayerSpawnLocations;
+        BuildingSpawnLocations = LoadedMapData->BuildingSpawnLocations;
+    }
+    else
+    {
+        //TODO: read from layers
+        EnemySpawnLocations.Reset();
+        if (auto TiledMap = GetRenderComponent())
+        {
+            int Width, Height, NumLayers;
+            TiledMap->GetMapSize(Width, Height, NumLayers);
+
+            for (int ox = 0; ox < Width && ox < 4; ox++)
+            {
+                for (int oy = 0; oy < Height; oy++)
+                {
+                    EnemySpawnLocations.Emplace(ox, oy);
+                }
+            }
+        }
+
+        //TODO: read from layers
+        PlayerSpawnLocations.Reset();
+        if (auto TiledMap = GetRenderComponent())
+        {
+            int Width, Height, NumLayers;
+            TiledMap->GetMapSize(Width, Height, NumLayers);
+
+            for (int ox = Width - 4; ox < Width; ox++)
+            {
+                for (int oy = 0; oy < Height; oy++)
+                {
+                    PlayerSpawnLocations.Emplace(ox, oy);
+                }
+            }
+        }
+
+        //TODO: read from layers
+        BuildingSpawnLocations.Reset();
+        if (auto TiledMap = GetRenderComponent())
+        {
+            int Width, Height, NumLayers;
+            TiledMap->GetMapSize(Width, Height, NumLayers);
+
+            for (int ox = Width - 5; ox < Width; ox++)
+            {
+                for (int oy = 0; oy < Height; oy++)
+                {
+                    BuildingSpawnLocations.Emplace(ox, oy);
+                }
+            }
+        }
+    }
+
+    PlayerSpawnBoard.Init(CellsWidth, CellsHeight);
+    for (const auto& Location : PlayerSpawnLocations)
+    {
+        PlayerSpawnBoard.Set(Location);
+    }
+
+    EnemySpawnBoard.Init(CellsWidth, CellsHeight);
+    for (const auto& Location : EnemySpawnLocations)
+    {
+        EnemySpawnBoard.Set(Location);
     }
 
     //Spawn Buildings
@@ -7,12 +7,19 @@
 #include "PaperTileMapActor.h"
 #include "WeakObjectPtr.h"
 #include "Util.h"
+#include "HexBitboard.h"
+#include "TurnArena.h"
+#include "HexInfluenceMap.h"
+#include "HexMapGenerator.h"
 #include "HexMap.generated.h"
 
 class USceneComponent;
 class UPaperTileMap;
+class UHexMapData;
 class AHexCell;
 class UCurveFloat;
+class APlayerController;
+class UHexAnimationScheduler;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FHexMapEvent, class AHexMap*, HexMap);
 
@@ -22,6 +29,27 @@ enum class ECellTransitionType : uint8
     Left, Right, Up, Down, Random
 };
 
+UENUM(BlueprintType)
+enum class EHexHighlightChannel : uint8
+{
+    Movement,
+    Attack,
+    PendingSpawn,
+    EnemyAttack,
+
+    Count UMETA(Hidden)
+};
+
+UENUM(BlueprintType)
+enum class EHexInfluenceLayer : uint8
+{
+    Threat,     //Reach of friendly attacks
+    Attraction, //Pull towards friendlies, high value targets pull harder
+    Danger,     //Cells telegraphed by pending enemy attacks
+
+    Count UMETA(Hidden)
+};
+
 USTRUCT(BlueprintType)
 struct LD45_API FHexTileTypeData : public FTableRowBase
 {
@@ -57,18 +85,84 @@ public:
     UFUNCTION(BlueprintCallable)
     virtual bool SetTileMap(UPaperTileMap* NewTileMap);
 
+    //Builds the board from baked data instead of the tile map, see UHexMapData
+    UFUNCTION(BlueprintCallable)
+    virtual bool SetMapData(UHexMapData* NewMapData);
+
+    UFUNCTION(BlueprintCallable)
+    UHexMapData* GetMapData() const { return MapData; }
+
+    //Builds a new board from GeneratorSettings with the given seed, laid out like the current tile map
+    UFUNCTION(BlueprintCallable)
+    bool GenerateMap(int Seed);
+
+    //Names the current board for save games, the tile map or map data path, or the seed it was generated from
+    UFUNCTION(BlueprintCallable)
+    FString GetMapId() const;
+
+    //Switches to the board a GetMapId result names and builds it straight away, skipping the transition
+    bool SetMapId(const FString& MapId);
+
     UFUNCTION(BlueprintCallable)
     const TArray<AHexCell*>& GetCells() const { return Cells; }
 
+    bool GetUseFlatHierarchy() const { return UseFlatHierarchy; }
+
+    //Flat hierarchy only, the cell and its occupant are moved in the next transform flush
+    void MarkCellTransformDirty(int Index);
+
     UFUNCTION(BlueprintCallable)
     virtual void RefreshCells();
 
+    //Cell coordinate where a world space ray meets the map plane, no collision needed. False if it misses the board
+    UFUNCTION(BlueprintCallable)
+    bool GetCoordFromWorldRay(const FVector& RayOrigin, const FVector& RayDirection, FHexMapCoord& OutCoord) const;
+
+    UFUNCTION(BlueprintCallable)
+    AHexCell* GetCellFromWorldRay(const FVector& RayOrigin, const FVector& RayDirection) const;
+
+    UFUNCTION(BlueprintCallable)
+    AHexCell* GetCellUnderCursor(APlayerController* PlayerController) const;
+
+    //Snaps any running transition to its end, used by tooling that can't wait on ticks
+    void FinishTransitions();
+
+    //Loads chunks around the camera and entities and evicts the ones left behind, only used with UseChunkedCells
+    void UpdateStreaming();
+
     UFUNCTION(BlueprintCallable)
     virtual void HighlightCells(const TArray<FHexMapCoord>& Cells, FColor Color);
 
     UFUNCTION(BlueprintCallable)
     virtual void UnhighlightAllCells();
 
+    //Replaces the channel's highlighted set, events only fire for cells whose state changed
+    UFUNCTION(BlueprintCallable)
+    void SetHighlightedCells(EHexHighlightChannel Channel, const TArray<FHexMapCoord>& Coords, FColor Color);
+
+    //As above, Mask is indexed by GetCellIndex
+    void SetHighlightMask(EHexHighlightChannel Channel, const TBitArray<>& Mask, FColor Color);
+
+    UFUNCTION(BlueprintCallable)
+    void AddHighlightedCells(EHexHighlightChannel Channel, const TArray<FHexMapCoord>& Coords, FColor Color);
+
+    UFUNCTION(BlueprintCallable)
+    void RemoveHighlightedCells(EHexHighlightChannel Channel, const TArray<FHexMapCoord>& Coords);
+
+    UFUNCTION(BlueprintCallable)
+    void ClearHighlightChannel(EHexHighlightChannel Channel);
+
+    //Telegraphed attacks are counted per cell, EnemyAttack only changes when a cell goes to or from zero attackers
+    void AddAttackOverlay(TArrayView<const FHexMapCoord> Coords);
+    void RemoveAttackOverlay(TArrayView<const FHexMapCoord> Coords);
+    void ClearAttackOverlay();
+
+    UFUNCTION(BlueprintCallable)
+    int GetAttackOverlayCount(const FHexMapCoord& Coord) const;
+
+    UFUNCTION(BlueprintCallable)
+    bool IsCellHighlighted(EHexHighlightChannel Channel, const FHexMapCoord& Coord) const;
+
     UFUNCTION(BlueprintCallable)
     const TArray<FHexMapCoord>& GetPlayerSpawnLocations() const { return PlayerSpawnLocations;}
 
@@ -81,25 +175,143 @@ public:
     UFUNCTION(BlueprintCallable)
     TArray<FHexMapCoord> GetValidEnemySpawnLocations() const;
 
+    //Arena backed versions for per turn queries
+    void GatherValidPlayerSpawnLocations(TTurnArray<FHexMapCoord>& OutLocations) const { GetValidSpawnLocations(PlayerSpawnBoard, OutLocations); }
+    void GatherValidEnemySpawnLocations(TTurnArray<FHexMapCoord>& OutLocations) const { GetValidSpawnLocations(EnemySpawnBoard, OutLocations); }
+
+    UFUNCTION(BlueprintCallable)
+    bool IsPlayerSpawnLocation(const FHexMapCoord& Coord) const { return PlayerSpawnBoard.Get(Coord); }
+
+    UFUNCTION(BlueprintCallable)
+    bool IsEnemySpawnLocation(const FHexMapCoord& Coord) const { return EnemySpawnBoard.Get(Coord); }
+
 	UFUNCTION(BlueprintCallable)
     void GetAdjacentHexCoords(const FHexMapCoord& Coord, TArray<FHexMapCoord>& OutAdjacent) const;
 
     UFUNCTION(BlueprintCallable)
     bool GetNextCoordInDirection(const FHexMapCoord& Coord, int Direction, FHexMapCoord& OutCoord) const;
 
+    //With UseChunkedCells this is null while the cell's chunk is streamed out, occupied cells are always resident
     UFUNCTION(BlueprintCallable)
     AHexCell* GetCell(int x, int y) const;    
 
+    //As GetCell but streams the cell's chunk in first, for moving or spawning onto the cell
+    UFUNCTION(BlueprintCallable)
+    AHexCell* GetOrLoadCell(int x, int y);
+
     UFUNCTION(BlueprintCallable)
-    bool IsTraversable(const FHexMapCoord& Coord, class AMapEntity* Entity = nullptr) const;
+    static int GetHexDistance(const FHexMapCoord& A, const FHexMapCoord& B);
+
+    UFUNCTION(BlueprintCallable)
+    bool IsTraversable(const FHexMapCoord& Coord, const class AMapEntity* Entity = nullptr) const;
+
+    UFUNCTION(BlueprintCallable)
+    int GetMapWidth() const { return CellsWidth; }
+
+    UFUNCTION(BlueprintCallable)
+    int GetMapHeight() const { return CellsHeight; }
+
+    int GetCellIndex(const FHexMapCoord& Coord) const { return Coord.x + (Coord.y * CellsWidth); }
+
+    //Incremented whenever cells are rebuilt or their occupancy changes, used to invalidate cached queries
+    UFUNCTION(BlueprintCallable)
+    int GetBoardVersion() const { return BoardVersion; }
+
+    void MarkBoardChanged() { BoardVersion++; }
+
+    //Re-reads the cell's terrain and occupancy into the packed grid
+    UFUNCTION(BlueprintCallable)
+    void NotifyCellChanged(AHexCell* Cell);
+
+    //EHexCellFlags per cell, indexed by GetCellIndex
+    const TArray<uint8>& GetCellFlags() const { return CellFlags; }
+
+    //Cells with a single EHexCellFlags bit set, kept in step with GetCellFlags
+    const FHexBitboard& GetFlagBoard(uint8 Flag) const;
+
+    //Cells within Radius of either side's entities
+    void GetZoneOfControl(bool Friendly, int Radius, FHexBitboard& OutZone) const;
+
+    //Cells hit by attacks of Distance in any direction from Sources, for every source at once
+    void GetAttackMask(const FHexBitboard& Sources, int Distance, FHexBitboard& OutMask) const;
+
+    //Cells visible from Source within Radius, cached per source, radius and board version. Indexed by GetCellIndex.
+    //Shared with the cache, so later queries can't move or drop a result that's still held
+    TSharedRef<const TBitArray<>> GetFieldOfView(const FHexMapCoord& Source, int Radius);
+
+    UFUNCTION(BlueprintCallable)
+    TArray<FHexMapCoord> GetVisibleCells(const FHexMapCoord& Source, int Radius);
+
+    UFUNCTION(BlueprintCallable)
+    bool HasLineOfSight(const FHexMapCoord& From, const FHexMapCoord& To);
+
+    //Restamps the entity's presence at its current cell, or removes it if it has none
+    void UpdateEntityInfluence(class AMapEntity* Entity);
+
+    void RemoveEntityInfluence(class AMapEntity* Entity);
+
+    //Pass an empty array to clear the entity's telegraph
+    void SetAttackInfluence(class AMapEntity* Entity, const TArray<FHexMapCoord>& Locations);
+
+    //Blurred influence, the blur is only recomputed for layers changed since the last query
+    UFUNCTION(BlueprintCallable)
+    float GetInfluence(EHexInfluenceLayer Layer, const FHexMapCoord& Coord);
+
+    //Higher is better for an enemy standing on Coord
+    UFUNCTION(BlueprintCallable)
+    float GetEnemyMoveScore(const FHexMapCoord& Coord);
 
 private:
 
+    //Stands in for the attraction layer beyond AttractionRadius of every friendly, where it has faded to nothing.
+    //Negative and falling with distance to the nearest friendly, so enemies on large boards still close in
+    float GetDistantAttraction(const FHexMapCoord& Coord) const;
+
+    void RequestRefresh();
     void StartTransition(bool TransitionIn);
+    void AdvanceTransition(float DeltaTime);
     bool UpdateCellTransitions();
 
     void PostLoadCells();
 
+    //Fills CellTypes from the tile map, leaves it empty if there's nothing to read
+    void ReadTileMapCellTypes();
+    void ReadMapDataCellTypes();
+    uint8 FindOrAddCellType(FName TileType);
+
+    FVector GetCellWorldLocation(const FHexMapCoord& Coord) const;
+    FHexLayoutBasis ReadLayoutBasis() const;
+    AHexCell* SpawnCell(int Index);
+
+    void FlushCellTransforms();
+
+    bool HasAnimationWork() const { return CellTransitions.Num() > 0 || AnyCellTransformDirty; }
+    void ScheduleAnimation();
+    bool UpdateAnimation(float DeltaTime);
+
+    //Asks the scheduler, which can drop the work, e.g. when it's cancelled
+    bool IsAnimationScheduled() const;
+
+    void HandleTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+    int GetChunkIndex(const FHexMapCoord& Coord) const;
+    void LoadChunk(int ChunkIndex);
+    bool TryEvictChunk(int ChunkIndex);
+    bool GetCameraFocusCoord(FHexMapCoord& OutCoord) const;
+
+    //Like GetCoordFromWorldRay but the coordinate may be off the board
+    bool IntersectMapPlane(const FVector& RayOrigin, const FVector& RayDirection, FHexMapCoord& OutCoord) const;
+
+    uint8 ReadCellFlags(const AHexCell* Cell) const;
+    void SetCellFlags(int Index, uint8 Flags);
+
+    void GetValidSpawnLocations(const FHexBitboard& Zone, TTurnArray<FHexMapCoord>& OutLocations) const;
+
+    void ResetInfluence();
+
+    void SetCellHighlightState(int Index, EHexHighlightChannel Channel, bool IsOn);
+    void ResetHighlightLayers();
+
 public:
 
     UPROPERTY(BlueprintAssignable)
@@ -110,6 +322,13 @@ protected:
     UPROPERTY(EditAnywhere)
     UDataTable* TileDataTable = nullptr;
 
+    //Used over the tile map when set
+    UPROPERTY(EditAnywhere)
+    UHexMapData* MapData = nullptr;
+
+    UPROPERTY(EditAnywhere, Category = Generation)
+    FHexMapGeneratorSettings GeneratorSettings;
+
     UPROPERTY(EditAnywhere)
     TSubclassOf<class AMapEntity> BuildingEntityClass;
 
@@ -125,6 +344,52 @@ protected:
     UPROPERTY(EditAnywhere)
     float MaxCellTransitionDuration;
 
+    UPROPERTY(EditAnywhere, Category = AI)
+    int AttractionRadius;
+
+    UPROPERTY(EditAnywhere, Category = AI)
+    float HighValueAttraction;
+
+    UPROPERTY(EditAnywhere, Category = AI)
+    float AttractionWeight;
+
+    UPROPERTY(EditAnywhere, Category = AI)
+    float ThreatWeight;
+
+    UPROPERTY(EditAnywhere, Category = AI)
+    float DangerWeight;
+
+    //Only spawn cell actors for chunks near the camera or entities, for boards too big to keep every cell alive
+    UPROPERTY(EditAnywhere, Category = Streaming)
+    bool UseChunkedCells;
+
+    //Cells along each side of a chunk
+    UPROPERTY(EditAnywhere, Category = Streaming, meta = (EditCondition = "UseChunkedCells", ClampMin = 1))
+    int ChunkSize;
+
+    //Chunks either side of the one the camera looks at
+    UPROPERTY(EditAnywhere, Category = Streaming, meta = (EditCondition = "UseChunkedCells", ClampMin = 0))
+    int CameraChunkRadius;
+
+    //Chunks either side of each entity
+    UPROPERTY(EditAnywhere, Category = Streaming, meta = (EditCondition = "UseChunkedCells", ClampMin = 0))
+    int EntityChunkRadius;
+
+    //Extra chunks a loaded chunk may drift out of range before it's evicted
+    UPROPERTY(EditAnywhere, Category = Streaming, meta = (EditCondition = "UseChunkedCells", ClampMin = 0))
+    int ChunkEvictHysteresis;
+
+    UPROPERTY(EditAnywhere, Category = Streaming, meta = (EditCondition = "UseChunkedCells"))
+    float StreamingInterval;
+
+    //Cells spawn without collision, for when everything picks through GetCellFromWorldRay
+    UPROPERTY(EditAnywhere, Category = Picking)
+    bool DisableCellCollision;
+
+    //Cells and entities stay unattached and are placed from map computed transforms, flushed once per frame
+    UPROPERTY(EditAnywhere, Category = Transform)
+    bool UseFlatHierarchy;
+
 private:
 
     UPROPERTY(Transient)
@@ -142,14 +407,89 @@ private:
     TArray<FCellTransition> CellTransitions;
 
     float CellTransitionTick = 0.0f;
+
+    //Tile centres in the render component's space, refreshed with the cells
+    FHexLayoutBasis LayoutBasis;
+
+    //Flat hierarchy: transition height per cell on top of its map position, and cells to move this frame
+    TArray<float> CellHeightOffsets;
+    TBitArray<> DirtyCellTransforms;
+    bool AnyCellTransformDirty = false;
+
+    //Transitions and transform flushes run from the animation scheduler when there is one, otherwise from Tick
+    TWeakObjectPtr<UHexAnimationScheduler> AnimationScheduler;
+    int ScheduledAnimationId = INDEX_NONE;
+
+    struct FHighlightLayer
+    {
+        TBitArray<> Mask;
+        FColor Color;
+    };
+    FHighlightLayer HighlightLayers[(int)EHexHighlightChannel::Count];
+
+    //Telegraphs covering each cell, indexed by GetCellIndex
+    TArray<uint16> AttackOverlayCounts;
     
 private:
 
     int CellsWidth = 0;
     int CellsHeight = 0;
 
+    int BoardVersion = 0;
+
+    TArray<uint8> CellFlags;
+
+    enum { NumFlagBoards = 4 };
+    FHexBitboard FlagBoards[NumFlagBoards];
+
+    //Index into CellTypeNames plus one per cell, 0 for no cell. Always resident, actors are built from it
+    TArray<uint8> CellTypes;
+    TArray<FName> CellTypeNames;
+
+    UPROPERTY(Transient)
+    TArray<TSubclassOf<AHexCell>> CellTypeClasses;
+
+    //MapData as of the last refresh
+    UPROPERTY(Transient)
+    UHexMapData* LoadedMapData = nullptr;
+
+    //MapData came from GenerateMap, it has no asset path to save
+    bool HasGeneratedSeed = false;
+    int GeneratedSeed = 0;
+
+    int ChunksWide = 0;
+    int ChunksHigh = 0;
+    TBitArray<> LoadedChunks;
+    float StreamingTimer = 0.0f;
+
+    struct FFieldOfViewCacheEntry
+    {
+        TSharedRef<const TBitArray<>> Visible;
+        int BoardVersion;
+    };
+    TMap<uint64, FFieldOfViewCacheEntry> FieldOfViewCache;
+
+    struct FInfluenceStamp
+    {
+        EHexInfluenceLayer Layer;
+        FHexMapCoord Center;
+        float Strength;
+        int Radius;
+    };
+
+    //What each entity has added to the raw layers, so moves can be undone incrementally
+    TMap<const AMapEntity*, TArray<FInfluenceStamp, TInlineAllocator<2>>> PresenceStamps;
+    TMap<const AMapEntity*, TArray<FHexMapCoord>> AttackStamps;
+
+    FHexInfluenceMap RawInfluence[(int)EHexInfluenceLayer::Count];
+    FHexInfluenceMap BlurredInfluence[(int)EHexInfluenceLayer::Count];
+    bool IsInfluenceDirty[(int)EHexInfluenceLayer::Count];
+
     TArray<FHexMapCoord> PlayerSpawnLocations;
     TArray<FHexMapCoord> EnemySpawnLocations;
     TArray<FHexMapCoord> BuildingSpawnLocations;
 
+    FHexBitboard PlayerSpawnBoard;
+    FHexBitboard EnemySpawnBoard;
+
 };
@@ -0,0 +1,213 @@
+#include "HexMapData.h"
+#include "PaperTileMap.h"
+#include "PaperTileLayer.h"
+#include "PaperTileSet.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/LargeMemoryReader.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogHexMapData, Log, All)
+
+namespace
+{
+    const uint32 HexMapDataMagic = 0x4D584548; //"HEXM"
+    const int32 HexMapDataVersion = 1;
+}
+
+void UHexMapData::BakeFromTileMap(const UPaperTileMap* TileMap)
+{
+    Width = Height = 0;
+    CellTypeNames.Reset();
+    CellTypes.Reset();
+    CellPositions.Reset();
+    PlayerSpawnLocations.Reset();
+    EnemySpawnLocations.Reset();
+    BuildingSpawnLocations.Reset();
+
+    if (!TileMap || TileMap->TileLayers.Num() == 0)
+    {
+        return;
+    }
+
+    Width = TileMap->MapWidth;
+    Height = TileMap->MapHeight;
+    CellTypes.Reserve(Width * Height);
+    CellPositions.Reserve(Width * Height);
+
+    const UPaperTileLayer* Layer = TileMap->TileLayers[0];
+    for (int y = 0; y < Height; y++)
+    {
+        for (int x = 0; x < Width; x++)
+        {
+            uint8 CellType = 0;
+            FPaperTileInfo TileInfo = Layer->GetCell(x, y);
+            if (TileInfo.TileSet)
+            {
+                auto TileMetaData = TileInfo.TileSet->GetTileMetadata(TileInfo.GetTileIndex());
+                if (TileMetaData && TileMetaData->HasMetaData())
+                {
+                    int Index = CellTypeNames.AddUnique(TileMetaData->UserDataName);
+                    if (ensureMsgf(Index < MAX_uint8, TEXT("Too many tile types in %s"), *GetNameSafe(TileMap)))
+                    {
+                        CellType = uint8(Index + 1);
+                    }
+                }
+                else
+                {
+                    UE_LOG(LogHexMapData, Warning, TEXT("No meta data for index %d at (%d,%d) in %s"), TileInfo.GetTileIndex(), x, y, *GetNameSafe(TileMap));
+                }
+            }
+            CellTypes.Add(CellType);
+            CellPositions.Add(TileMap->GetTileCenterInLocalSpace(x, y, 0));
+        }
+    }
+
+    //TODO: read from layers, these match AHexMap's defaults for unbaked maps
+    for (int x = 0; x < Width && x < 4; x++)
+    {
+        for (int y = 0; y < Height; y++)
+        {
+            EnemySpawnLocations.Emplace(x, y);
+        }
+    }
+    for (int x = FMath::Max(Width - 4, 0); x < Width; x++)
+    {
+        for (int y = 0; y < Height; y++)
+        {
+            PlayerSpawnLocations.Emplace(x, y);
+        }
+    }
+    for (int x = FMath::Max(Width - 5, 0); x < Width; x++)
+    {
+        for (int y = 0; y < Height; y++)
+        {
+            BuildingSpawnLocations.Emplace(x, y);
+        }
+    }
+}
+
+bool UHexMapData::IsValid() const
+{
+    const int NumCells = Width * Height;
+    if (Width <= 0 || Height <= 0 || CellTypes.Num() != NumCells || CellPositions.Num() != NumCells || CellTypeNames.Num() > MAX_uint8)
+    {
+        return false;
+    }
+
+    //Bytes index CellTypeNames + 1, anything past the palette would read off the end of the remap
+    const uint8 MaxCellType = uint8(CellTypeNames.Num());
+    for (uint8 CellType : CellTypes)
+    {
+        if (CellType > MaxCellType)
+        {
+            return false;
+        }
+    }
+
+    for (const auto* SpawnLocations : { &PlayerSpawnLocations, &EnemySpawnLocations, &BuildingSpawnLocations })
+    {
+        for (const auto& Coord : *SpawnLocations)
+        {
+            if (!Coord.IsValid(Width, Height))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void UHexMapData::Serialize(FArchive& Ar)
+{
+    Super::Serialize(Ar);
+    SerializeData(Ar);
+}
+
+void UHexMapData::SerializeData(FArchive& Ar)
+{
+    uint32 Magic = HexMapDataMagic;
+    int32 Version = HexMapDataVersion;
+    Ar << Magic << Version;
+    if (Ar.IsLoading() && (Magic != HexMapDataMagic || Version != HexMapDataVersion))
+    {
+        UE_LOG(LogHexMapData, Error, TEXT("%s has unsupported map data (magic %x, version %d), rebake it"), *GetName(), Magic, Version);
+        Ar.SetError();
+        return;
+    }
+
+    Ar << Width << Height;
+    Ar << CellTypeNames;
+
+    //Plain old data, loads as one memcpy per array
+    CellTypes.BulkSerialize(Ar);
+    CellPositions.BulkSerialize(Ar);
+    PlayerSpawnLocations.BulkSerialize(Ar);
+    EnemySpawnLocations.BulkSerialize(Ar);
+    BuildingSpawnLocations.BulkSerialize(Ar);
+}
+
+bool UHexMapData::SaveToFile(const FString& Filename)
+{
+    TArray<uint8> Bytes;
+    FMemoryWriter Writer(Bytes, true);
+    SerializeData(Writer);
+    return !Writer.IsError() && FFileHelper::SaveArrayToFile(Bytes, *Filename);
+}
+
+UHexMapData* UHexMapData::LoadFromFile(const FString& Filename, bool UseMappedFile, UObject* Outer)
+{
+    UHexMapData* MapData = NewObject<UHexMapData>(Outer ? Outer : GetTransientPackage());
+
+    bool Loaded = false;
+    if (UseMappedFile)
+    {
+        TUniquePtr<IMappedFileHandle> Handle(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Filename));
+        TUniquePtr<IMappedFileRegion> Region(Handle ? Handle->MapRegion(0, Handle->GetFileSize()) : nullptr);
+        if (Region)
+        {
+            FLargeMemoryReader Reader(Region->GetMappedPtr(), Region->GetMappedSize());
+            MapData->SerializeData(Reader);
+            Loaded = !Reader.IsError();
+        }
+    }
+
+    //Not every platform can map files, fall back to one read of the whole file
+    if (!Loaded)
+    {
+        TArray<uint8> Bytes;
+        if (FFileHelper::LoadFileToArray(Bytes, *Filename))
+        {
+            FLargeMemoryReader Reader(Bytes.GetData(), Bytes.Num());
+            MapData->SerializeData(Reader);
+            Loaded = !Reader.IsError();
+        }
+    }
+
+    if (!Loaded || !MapData->IsValid())
+    {
+        UE_LOG(LogHexMapData, Error, TEXT("Failed to load map data from %s%s"), *Filename, Loaded ? TEXT(", the data is inconsistent") : TEXT(""));
+        return nullptr;
+    }
+    return MapData;
+}
+
+#if WITH_EDITOR
+void UHexMapData::PreSave(const class ITargetPlatform* TargetPlatform)
+{
+    Super::PreSave(TargetPlatform);
+
+    //Keeps the baked data in step with the tile map it came from, including at cook time
+    if (SourceTileMap)
+    {
+        BakeFromTileMap(SourceTileMap);
+    }
+}
+
+void UHexMapData::Bake()
+{
+    BakeFromTileMap(SourceTileMap);
+    MarkPackageDirty();
+}
+#endif
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Util.h"
+#include "HexMapData.generated.h"
+
+class UPaperTileMap;
+
+/**
+ * A tile map baked down to what AHexMap needs to build its board, so loading is a few bulk array reads
+ * instead of per tile lookups. Baked from SourceTileMap whenever the asset is saved or cooked.
+ */
+UCLASS(BlueprintType)
+class LD45_API UHexMapData : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+    //Rebuilds everything from the tile map's first layer
+    void BakeFromTileMap(const UPaperTileMap* TileMap);
+
+    //Loose binary files, for maps produced outside the editor. Mapping avoids the copy into a read buffer
+    bool SaveToFile(const FString& Filename);
+    static UHexMapData* LoadFromFile(const FString& Filename, bool UseMappedFile = true, UObject* Outer = nullptr);
+
+    void Serialize(FArchive& Ar) override;
+
+#if WITH_EDITOR
+    void PreSave(const class ITargetPlatform* TargetPlatform) override;
+
+    UFUNCTION(CallInEditor, Category = Bake)
+    void Bake();
+#endif
+
+    UFUNCTION(BlueprintCallable)
+    int GetWidth() const { return Width; }
+
+    UFUNCTION(BlueprintCallable)
+    int GetHeight() const { return Height; }
+
+    //Sizes agree, every type byte is in the palette and spawns are on the board. Loose files are checked before use
+    bool IsValid() const;
+
+public:
+
+#if WITH_EDITORONLY_DATA
+    UPROPERTY(EditAnywhere, Category = Bake)
+    UPaperTileMap* SourceTileMap = nullptr;
+#endif
+
+    int Width = 0;
+    int Height = 0;
+
+    //Tile type row names, CellTypes holds index + 1 with 0 for no cell
+    TArray<FName> CellTypeNames;
+    TArray<uint8> CellTypes;
+
+    //Tile centres in the map's local space
+    TArray<FVector> CellPositions;
+
+    TArray<FHexMapCoord> PlayerSpawnLocations;
+    TArray<FHexMapCoord> EnemySpawnLocations;
+    TArray<FHexMapCoord> BuildingSpawnLocations;
+
+private:
+
+    void SerializeData(FArchive& Ar);
+};
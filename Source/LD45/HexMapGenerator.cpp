@@ -0,0 +1,201 @@
+#include "HexMapGenerator.h"
+#include "HexMapData.h"
+#include "Util.h"
+#include "Async/ParallelFor.h"
+#include "UObject/Package.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogHexMapGenerator, Log, All)
+
+namespace
+{
+    enum ECellType : uint8
+    {
+        Hole = 0,
+        Floor = 1,
+        Wall = 2
+    };
+
+    //Stateless so rows can be filled in any order on any thread
+    FORCEINLINE float LatticeValue(uint32 Seed, int x, int y)
+    {
+        uint32 Hash = Seed ^ (uint32(x) * 0x8DA6B343u) ^ (uint32(y) * 0xD8163841u);
+        Hash ^= Hash >> 13;
+        Hash *= 0x9E3779B1u;
+        Hash ^= Hash >> 16;
+        return float(Hash & 0xFFFFFF) / float(0xFFFFFF);
+    }
+
+    float ValueNoise(uint32 Seed, float x, float y)
+    {
+        const int x0 = FMath::FloorToInt(x);
+        const int y0 = FMath::FloorToInt(y);
+        const float tx = FMath::SmoothStep(0.0f, 1.0f, x - x0);
+        const float ty = FMath::SmoothStep(0.0f, 1.0f, y - y0);
+        const float Top = FMath::Lerp(LatticeValue(Seed, x0, y0), LatticeValue(Seed, x0 + 1, y0), tx);
+        const float Bottom = FMath::Lerp(LatticeValue(Seed, x0, y0 + 1), LatticeValue(Seed, x0 + 1, y0 + 1), tx);
+        return FMath::Lerp(Top, Bottom, ty);
+    }
+
+    float LayeredNoise(const FHexMapGeneratorSettings& Settings, float x, float y)
+    {
+        float Total = 0.0f;
+        float Amplitude = 1.0f;
+        float AmplitudeSum = 0.0f;
+        float Scale = 1.0f / FMath::Max(Settings.FeatureSize, 1.0f);
+        for (int Octave = 0; Octave < FMath::Max(Settings.Octaves, 1); Octave++)
+        {
+            Total += Amplitude * ValueNoise(uint32(Settings.Seed) + Octave * 0x68E31DA4u, x * Scale, y * Scale);
+            AmplitudeSum += Amplitude;
+            Amplitude *= Settings.Persistence;
+            Scale *= 2.0f;
+        }
+        return Total / AmplitudeSum;
+    }
+}
+
+UHexMapData* FHexMapGenerator::Generate(const FHexMapGeneratorSettings& Settings, const FHexLayoutBasis& Basis, UObject* Outer)
+{
+    const int Width = FMath::Max(Settings.Width, 8);
+    const int Height = FMath::Max(Settings.Height, 8);
+    const int ZoneColumns = FMath::Clamp(Settings.SpawnZoneColumns, 1, Width / 2);
+
+    UHexMapData* MapData = NewObject<UHexMapData>(Outer ? Outer : GetTransientPackage());
+    MapData->Width = Width;
+    MapData->Height = Height;
+    MapData->CellTypes.SetNumUninitialized(Width * Height);
+    MapData->CellPositions.SetNumUninitialized(Width * Height);
+
+    TArray<uint8>& Types = MapData->CellTypes;
+
+    //Offset coords are sheared into hex space so features aren't stretched along rows
+    ParallelFor(Height, [&](int32 y)
+    {
+        for (int x = 0; x < Width; x++)
+        {
+            const int Index = x + y * Width;
+            const float Noise = LayeredNoise(Settings, x + (y & 1) * 0.5f, y * 0.866f);
+            Types[Index] = Noise < Settings.HoleThreshold ? Hole : (Noise > Settings.WallThreshold ? Wall : Floor);
+            MapData->CellPositions[Index] = Basis.GetPosition(x, y);
+        }
+    });
+
+    //Flood from the enemy zone, then carve west along the row from any player zone cell it didn't reach
+    TBitArray<> Reached(false, Width * Height);
+    TArray<int> Queue;
+    Queue.Reserve(Width * Height);
+    int QueueHead = 0;
+
+    auto Reach = [&](int Index)
+    {
+        Reached[Index] = true;
+        Queue.Add(Index);
+    };
+
+    auto Flood = [&]()
+    {
+        while (QueueHead < Queue.Num())
+        {
+            const int Index = Queue[QueueHead++];
+            const FHexMapCoord Coord(Index % Width, Index / Width);
+            for (const auto& Direction : GetDirectionsAt(Coord))
+            {
+                const FHexMapCoord Next = Coord + Direction;
+                if (Next.IsValid(Width, Height))
+                {
+                    const int NextIndex = Next.x + Next.y * Width;
+                    if (Types[NextIndex] == Floor && !Reached[NextIndex])
+                    {
+                        Reach(NextIndex);
+                    }
+                }
+            }
+        }
+    };
+
+    auto CarveWest = [&](int x, int y)
+    {
+        for (; x >= 0; x--)
+        {
+            const int Index = x + y * Width;
+            if (Reached[Index])
+            {
+                break;
+            }
+            Types[Index] = Floor;
+            Reach(Index);
+        }
+    };
+
+    //Each zone needs at least one floor cell to start from
+    const int MidRow = Height / 2;
+    if (Types[MidRow * Width] != Floor)
+    {
+        Types[MidRow * Width] = Floor;
+    }
+    if (Types[(Width - 1) + MidRow * Width] != Floor)
+    {
+        Types[(Width - 1) + MidRow * Width] = Floor;
+    }
+
+    for (int y = 0; y < Height; y++)
+    {
+        for (int x = 0; x < ZoneColumns; x++)
+        {
+            if (Types[x + y * Width] == Floor)
+            {
+                Reach(x + y * Width);
+            }
+        }
+    }
+    Flood();
+
+    int NumCarved = 0;
+    for (int y = 0; y < Height; y++)
+    {
+        for (int x = Width - ZoneColumns; x < Width; x++)
+        {
+            if (Types[x + y * Width] == Floor && !Reached[x + y * Width])
+            {
+                CarveWest(x, y);
+                Flood();
+                NumCarved++;
+            }
+        }
+    }
+
+    //Palette matches ECellType, holes are only a real type when one is set
+    MapData->CellTypeNames = { Settings.FloorTileType, Settings.WallTileType };
+    if (Settings.HoleTileType != NAME_None)
+    {
+        MapData->CellTypeNames.Add(Settings.HoleTileType);
+        for (auto& Type : Types)
+        {
+            Type = Type == Hole ? 3 : Type;
+        }
+    }
+
+    for (int x = 0; x < ZoneColumns; x++)
+    {
+        for (int y = 0; y < Height; y++)
+        {
+            MapData->EnemySpawnLocations.Emplace(x, y);
+        }
+    }
+    for (int x = Width - ZoneColumns; x < Width; x++)
+    {
+        for (int y = 0; y < Height; y++)
+        {
+            MapData->PlayerSpawnLocations.Emplace(x, y);
+        }
+    }
+    for (int x = Width - ZoneColumns - 1; x < Width; x++)
+    {
+        for (int y = 0; y < Height; y++)
+        {
+            MapData->BuildingSpawnLocations.Emplace(x, y);
+        }
+    }
+
+    UE_LOG(LogHexMapGenerator, Log, TEXT("[Generate] %dx%d seed %d, %d corridors carved"), Width, Height, Settings.Seed, NumCarved);
+    return MapData;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Util.h"
+#include "HexMapGenerator.generated.h"
+
+class UHexMapData;
+
+USTRUCT(BlueprintType)
+struct LD45_API FHexMapGeneratorSettings
+{
+    GENERATED_BODY()
+
+public:
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 8))
+    int Width = 32;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 8))
+    int Height = 32;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    int Seed = 0;
+
+    //Tile type rows in the map's TileDataTable, None leaves a hole
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    FName FloorTileType = TEXT("Floor");
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    FName WallTileType = TEXT("Wall");
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    FName HoleTileType = NAME_None;
+
+    //Noise in [0,1], below HoleThreshold is a hole, above WallThreshold a wall, floor in between
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0, ClampMax = 1))
+    float HoleThreshold = 0.2f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0, ClampMax = 1))
+    float WallThreshold = 0.68f;
+
+    //Cells per noise lattice step of the first octave
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 1))
+    float FeatureSize = 8.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 1, ClampMax = 8))
+    int Octaves = 3;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0, ClampMax = 1))
+    float Persistence = 0.5f;
+
+    //Columns on each side reserved for spawning, enemies on the left and the player on the right
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 1))
+    int SpawnZoneColumns = 4;
+};
+
+//Where tile centres fall in the map's local space, odd rows are shifted by OddRowOffset
+struct FHexLayoutBasis
+{
+    FVector Origin = FVector::ZeroVector;
+    FVector ColumnStep = FVector(100.0f, 0.0f, 0.0f);
+    FVector RowPairStep = FVector(0.0f, 0.0f, -173.2f);
+    FVector OddRowOffset = FVector(50.0f, 0.0f, -86.6f);
+
+    FVector GetPosition(int x, int y) const
+    {
+        return Origin + ColumnStep * x + RowPairStep * (y / 2) + (y & 1 ? OddRowOffset : FVector::ZeroVector);
+    }
+
+    //Inverse of GetPosition for any point on the layout plane, the nearest centre wins. Can be off the map
+    FHexMapCoord GetCoord(const FVector& Position) const
+    {
+        //Axial q steps by ColumnStep and r by OddRowOffset, solved in the plane they span
+        const FVector Delta = Position - Origin;
+        const float CC = FVector::DotProduct(ColumnStep, ColumnStep);
+        const float CO = FVector::DotProduct(ColumnStep, OddRowOffset);
+        const float OO = FVector::DotProduct(OddRowOffset, OddRowOffset);
+        const float Det = CC * OO - CO * CO;
+        if (FMath::IsNearlyZero(Det))
+        {
+            return FHexMapCoord(-1, -1);
+        }
+        const float DC = FVector::DotProduct(Delta, ColumnStep);
+        const float DO = FVector::DotProduct(Delta, OddRowOffset);
+        const float q = (DC * OO - DO * CO) / Det;
+        const float r = (DO * CC - DC * CO) / Det;
+
+        //Cube rounding, fix up whichever axis rounded furthest
+        const float s = -q - r;
+        int rq = FMath::RoundToInt(q);
+        int rr = FMath::RoundToInt(r);
+        const int rs = FMath::RoundToInt(s);
+        const float dq = FMath::Abs(rq - q);
+        const float dr = FMath::Abs(rr - r);
+        const float ds = FMath::Abs(rs - s);
+        if (dq > dr && dq > ds)
+        {
+            rq = -rr - rs;
+        }
+        else if (dr > ds)
+        {
+            rr = -rq - rs;
+        }
+
+        return FHexMapCoord(rq + (rr - (rr & 1)) / 2, rr);
+    }
+};
+
+/**
+ * Seeded layered noise maps, repaired so the player's spawn zone can always reach the enemy spawn zone
+ */
+class LD45_API FHexMapGenerator
+{
+public:
+
+    static UHexMapData* Generate(const FHexMapGeneratorSettings& Settings, const FHexLayoutBasis& Basis, UObject* Outer = nullptr);
+};
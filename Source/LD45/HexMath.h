@@ -0,0 +1,247 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Util.h"
+
+/**
+ * Axial hex coordinate (cube coordinate with S implied), converts to and from the odd-row offset layout of FHexMapCoord
+ */
+struct FHexAxial
+{
+    int32 Q = 0;
+    int32 R = 0;
+
+    constexpr FHexAxial() {}
+    constexpr FHexAxial(int32 InQ, int32 InR) : Q(InQ), R(InR) {}
+
+    constexpr int32 S() const { return -Q - R; }
+
+    constexpr bool operator == (const FHexAxial& Rhs) const { return Q == Rhs.Q && R == Rhs.R; }
+    constexpr bool operator != (const FHexAxial& Rhs) const { return !(*this == Rhs); }
+
+    constexpr FHexAxial operator + (const FHexAxial& Rhs) const { return FHexAxial(Q + Rhs.Q, R + Rhs.R); }
+    constexpr FHexAxial operator - (const FHexAxial& Rhs) const { return FHexAxial(Q - Rhs.Q, R - Rhs.R); }
+    constexpr FHexAxial operator * (int32 Scale) const { return FHexAxial(Q * Scale, R * Scale); }
+
+    FHexAxial& operator += (const FHexAxial& Rhs) { Q += Rhs.Q; R += Rhs.R; return *this; }
+};
+
+namespace HexMath
+{
+    //Same order as GetDirectionsAt: NE, E, SE, SW, W, NW (y down)
+    constexpr FHexAxial Directions[6] = { {1,-1}, {1,0}, {0,1}, {-1,1}, {-1,0}, {0,-1} };
+
+    constexpr int32 Abs(int32 Value) { return Value < 0 ? -Value : Value; }
+
+    constexpr int32 Max3(int32 A, int32 B, int32 C) { return A > B ? (A > C ? A : C) : (B > C ? B : C); }
+
+    constexpr FHexAxial OffsetToAxial(int32 X, int32 Y) { return FHexAxial(X - ((Y - (Y & 1)) / 2), Y); }
+
+    constexpr int32 AxialToOffsetX(const FHexAxial& Axial) { return Axial.Q + ((Axial.R - (Axial.R & 1)) / 2); }
+
+    constexpr int32 AxialToOffsetY(const FHexAxial& Axial) { return Axial.R; }
+
+    FORCEINLINE FHexAxial OffsetToAxial(const FHexMapCoord& Coord) { return OffsetToAxial(Coord.x, Coord.y); }
+
+    FORCEINLINE FHexMapCoord AxialToOffset(const FHexAxial& Axial) { return FHexMapCoord(AxialToOffsetX(Axial), AxialToOffsetY(Axial)); }
+
+    constexpr FHexAxial Direction(int32 Index) { return Directions[((Index % 6) + 6) % 6]; }
+
+    constexpr FHexAxial Neighbor(const FHexAxial& Axial, int32 DirectionIndex) { return Axial + Direction(DirectionIndex); }
+
+    constexpr int32 Length(const FHexAxial& Axial) { return Max3(Abs(Axial.Q), Abs(Axial.R), Abs(Axial.S())); }
+
+    constexpr int32 Distance(const FHexAxial& A, const FHexAxial& B) { return Length(A - B); }
+
+    FORCEINLINE int32 Distance(const FHexMapCoord& A, const FHexMapCoord& B) { return Distance(OffsetToAxial(A), OffsetToAxial(B)); }
+
+    //60 degree steps around the origin, clockwise with y down
+    constexpr FHexAxial RotateCW(const FHexAxial& Axial) { return FHexAxial(-Axial.R, -Axial.S()); }
+
+    constexpr FHexAxial RotateCCW(const FHexAxial& Axial) { return FHexAxial(-Axial.S(), -Axial.Q); }
+
+    constexpr FHexAxial Rotate(const FHexAxial& Axial, int32 Steps)
+    {
+        return (((Steps % 6) + 6) % 6) == 0 ? Axial : Rotate(RotateCW(Axial), (((Steps % 6) + 6) % 6) - 1);
+    }
+
+    constexpr FHexAxial RotateAround(const FHexAxial& Axial, const FHexAxial& Center, int32 Steps) { return Center + Rotate(Axial - Center, Steps); }
+
+    //Number of cells within Radius of a cell, ignoring map bounds
+    constexpr int32 SpiralCount(int32 Radius) { return 1 + 3 * Radius * (Radius + 1); }
+
+    FORCEINLINE FHexAxial Round(float Q, float R)
+    {
+        float S = -Q - R;
+        int32 RQ = FMath::RoundToInt(Q);
+        int32 RR = FMath::RoundToInt(R);
+        int32 RS = FMath::RoundToInt(S);
+        float DQ = FMath::Abs(RQ - Q);
+        float DR = FMath::Abs(RR - R);
+        float DS = FMath::Abs(RS - S);
+        if (DQ > DR && DQ > DS)
+        {
+            RQ = -RR - RS;
+        }
+        else if (DR > DS)
+        {
+            RR = -RQ - RS;
+        }
+        return FHexAxial(RQ, RR);
+    }
+
+    //Same rounding in double, for interpolation that needs to keep a tiny nudge
+    FORCEINLINE FHexAxial Round(double Q, double R)
+    {
+        double S = -Q - R;
+        int32 RQ = int32(FMath::FloorToDouble(Q + 0.5));
+        int32 RR = int32(FMath::FloorToDouble(R + 0.5));
+        int32 RS = int32(FMath::FloorToDouble(S + 0.5));
+        double DQ = FMath::Abs(RQ - Q);
+        double DR = FMath::Abs(RR - R);
+        double DS = FMath::Abs(RS - S);
+        if (DQ > DR && DQ > DS)
+        {
+            RQ = -RR - RS;
+        }
+        else if (DR > DS)
+        {
+            RR = -RQ - RS;
+        }
+        return FHexAxial(RQ, RR);
+    }
+}
+
+/**
+ * Walks the cells exactly Radius steps from Center, a radius of 0 yields Center only
+ */
+class FHexRingIterator
+{
+public:
+
+    FHexRingIterator(const FHexAxial& InCenter, int32 InRadius)
+        : Current(InCenter + HexMath::Direction(4) * InRadius)
+        , Radius(InRadius)
+        , Side(0)
+        , Step(0)
+        , IsDone(InRadius < 0)
+    {
+    }
+
+    FORCEINLINE const FHexAxial& operator * () const { return Current; }
+
+    FORCEINLINE explicit operator bool() const { return !IsDone; }
+
+    FHexRingIterator& operator ++ ()
+    {
+        if (Radius == 0)
+        {
+            IsDone = true;
+            return *this;
+        }
+        Current += HexMath::Direction(Side);
+        if (++Step == Radius)
+        {
+            Step = 0;
+            IsDone = ++Side == 6;
+        }
+        return *this;
+    }
+
+private:
+
+    FHexAxial Current;
+    int32 Radius;
+    int32 Side;
+    int32 Step;
+    bool IsDone;
+};
+
+/**
+ * Walks every cell within Radius of Center, ring by ring outwards starting at Center
+ */
+class FHexSpiralIterator
+{
+public:
+
+    FHexSpiralIterator(const FHexAxial& InCenter, int32 InMaxRadius)
+        : Center(InCenter)
+        , MaxRadius(InMaxRadius)
+        , Ring(InCenter, 0)
+        , Radius(0)
+    {
+        if (MaxRadius < 0)
+        {
+            Radius = MaxRadius + 1;
+            Ring = FHexRingIterator(Center, -1);
+        }
+    }
+
+    FORCEINLINE const FHexAxial& operator * () const { return *Ring; }
+
+    FORCEINLINE explicit operator bool() const { return (bool)Ring; }
+
+    FORCEINLINE int32 GetRadius() const { return Radius; }
+
+    FHexSpiralIterator& operator ++ ()
+    {
+        ++Ring;
+        if (!Ring && Radius < MaxRadius)
+        {
+            Ring = FHexRingIterator(Center, ++Radius);
+        }
+        return *this;
+    }
+
+private:
+
+    FHexAxial Center;
+    int32 MaxRadius;
+    FHexRingIterator Ring;
+    int32 Radius;
+};
+
+/**
+ * Walks the cells on the straight line from Start to End inclusive
+ */
+class FHexLineIterator
+{
+public:
+
+    FHexLineIterator(const FHexAxial& InStart, const FHexAxial& InEnd)
+        : Start(InStart)
+        , End(InEnd)
+        , NumSteps(HexMath::Distance(InStart, InEnd))
+        , Step(0)
+        , Current(InStart)
+    {
+    }
+
+    FORCEINLINE const FHexAxial& operator * () const { return Current; }
+
+    FORCEINLINE explicit operator bool() const { return Step <= NumSteps; }
+
+    FORCEINLINE int32 GetStep() const { return Step; }
+
+    FHexLineIterator& operator ++ ()
+    {
+        if (++Step <= NumSteps)
+        {
+            //Nudge off the edges so ties always break the same way. Interpolating the offset from Start in double
+            //keeps the nudge above the rounding error however long the line is or far it is from the origin
+            const double Alpha = double(Step) / double(NumSteps);
+            const double Q = double(End.Q - Start.Q) * Alpha + 1e-9;
+            const double R = double(End.R - Start.R) * Alpha + 2e-9;
+            Current = Start + HexMath::Round(Q, R);
+        }
+        return *this;
+    }
+
+private:
+
+    FHexAxial Start;
+    FHexAxial End;
+    int32 NumSteps;
+    int32 Step;
+    FHexAxial Current;
+};
@@ -2,5 +2,47 @@
 
 #include "LD45.h"
 #include "Modules/ModuleManager.h"
+#include "LD45Stats.h"
+#include "LD45Benchmark.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, LD45, "LD45" );
+class FLD45GameModule : public FDefaultGameModuleImpl
+{
+public:
+
+    virtual void StartupModule() override
+    {
+#if !UE_BUILD_SHIPPING
+        //Swapped in once before any benchmark runs, LD45.Bench can then run any number of times
+        FLD45Benchmark::InstallAllocationCounter();
+#endif
+    }
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FLD45GameModule, LD45, "LD45" );
+
+DEFINE_STAT(STAT_LD45_RefreshCells);
+DEFINE_STAT(STAT_LD45_GetMoveLocations);
+DEFINE_STAT(STAT_LD45_GetAttacks);
+DEFINE_STAT(STAT_LD45_AIMove);
+DEFINE_STAT(STAT_LD45_AITelegraphAttack);
+DEFINE_STAT(STAT_LD45_AIResolveAttack);
+DEFINE_STAT(STAT_LD45_PlanEnemyTurn);
+DEFINE_STAT(STAT_LD45_EnemyTurnSteps);
+DEFINE_STAT(STAT_LD45_EventDispatch);
+DEFINE_STAT(STAT_LD45_Presentation);
+DEFINE_STAT(STAT_LD45_Snapshot);
+DEFINE_STAT(STAT_LD45_SpawnEnemies);
+DEFINE_STAT(STAT_LD45_AddPendingSpawns);
+DEFINE_STAT(STAT_LD45_FlowStateBroadcast);
+DEFINE_STAT(STAT_LD45_ApplyBoardCommands);
+DEFINE_STAT(STAT_LD45_FieldOfView);
+DEFINE_STAT(STAT_LD45_Influence);
+DEFINE_STAT(STAT_LD45_Highlight);
+DEFINE_STAT(STAT_LD45_CellTransforms);
+DEFINE_STAT(STAT_LD45_Animation);
+
+DEFINE_STAT(STAT_LD45_CellsTouched);
+DEFINE_STAT(STAT_LD45_EntitiesEvaluated);
+DEFINE_STAT(STAT_LD45_ArenaAllocations);
+DEFINE_STAT(STAT_LD45_ArenaBytes);
+DEFINE_STAT(STAT_LD45_EventsQueued);
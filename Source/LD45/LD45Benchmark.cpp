@@ -0,0 +1,575 @@
+#include "LD45Benchmark.h"
+#include "HexMap.h"
+#include "HexMath.h"
+#include "HexMapData.h"
+#include "HexCell.h"
+#include "MapEntity.h"
+#include "VoidGameMode.h"
+#include "GamePlayerController.h"
+#include "PaperTileMap.h"
+#include "PaperTileLayer.h"
+#include "PaperTileMapComponent.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/DateTime.h"
+#include "UObject/Package.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogLD45Benchmark, Log, All)
+
+/**
+ * Sits in front of GMalloc and counts the game thread's heap allocations while the benchmark asks it to.
+ * Put in once when the module starts and never taken out, every call goes straight through to the
+ * allocator it wraps so blocks from before it was installed are freed by the right one.
+ */
+class FLD45CountingMalloc : public FMalloc
+{
+public:
+
+    static FLD45CountingMalloc* Get() { return Instance; }
+
+    static void Install()
+    {
+        check(IsInGameThread());
+        //A hot reload starts the module again, the first one stays in place
+        if (Instance)
+        {
+            return;
+        }
+        Instance = new FLD45CountingMalloc(GMalloc);
+        GMalloc = Instance;
+    }
+
+    void SetCounting(bool InCounting)
+    {
+        check(IsInGameThread());
+        Counting = InCounting;
+    }
+
+    int GetNumAllocations() const { return NumAllocations; }
+
+    virtual void* Malloc(SIZE_T Size, uint32 Alignment) override
+    {
+        CountAllocation();
+        return UsedMalloc->Malloc(Size, Alignment);
+    }
+
+    virtual void* Realloc(void* Ptr, SIZE_T NewSize, uint32 Alignment) override
+    {
+        if (NewSize > 0)
+        {
+            CountAllocation();
+        }
+        return UsedMalloc->Realloc(Ptr, NewSize, Alignment);
+    }
+
+    virtual void Free(void* Ptr) override { UsedMalloc->Free(Ptr); }
+    virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return UsedMalloc->QuantizeSize(Count, Alignment); }
+    virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return UsedMalloc->GetAllocationSize(Original, SizeOut); }
+    virtual void SetupTLSCachesOnCurrentThread() override { UsedMalloc->SetupTLSCachesOnCurrentThread(); }
+    virtual void ClearAndDisableTLSCachesOnCurrentThread() override { UsedMalloc->ClearAndDisableTLSCachesOnCurrentThread(); }
+    virtual void InitializeStatsMetadata() override { UsedMalloc->InitializeStatsMetadata(); }
+    virtual void UpdateStats() override { UsedMalloc->UpdateStats(); }
+    virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { UsedMalloc->GetAllocatorStats(OutStats); }
+    virtual void DumpAllocatorStats(FOutputDevice& Ar) override { UsedMalloc->DumpAllocatorStats(Ar); }
+    virtual bool IsInternallyThreadSafe() const override { return UsedMalloc->IsInternallyThreadSafe(); }
+    virtual bool ValidateHeap() override { return UsedMalloc->ValidateHeap(); }
+    virtual const TCHAR* GetDescriptiveName() override { return UsedMalloc->GetDescriptiveName(); }
+
+private:
+
+    explicit FLD45CountingMalloc(FMalloc* InUsedMalloc)
+        : UsedMalloc(InUsedMalloc)
+    {
+    }
+
+    void CountAllocation()
+    {
+        //Counting is only touched on the game thread
+        if (IsInGameThread() && Counting)
+        {
+            NumAllocations++;
+        }
+    }
+
+    static FLD45CountingMalloc* Instance;
+
+    FMalloc* UsedMalloc;
+    bool Counting = false;
+    int NumAllocations = 0;
+};
+
+FLD45CountingMalloc* FLD45CountingMalloc::Instance = nullptr;
+
+void FLD45Benchmark::InstallAllocationCounter()
+{
+    FLD45CountingMalloc::Install();
+}
+
+static void NoSetup()
+{
+}
+
+//Nearest rank on sorted samples
+static double NearestRank(const TArray<double>& Sorted, double Percentile)
+{
+    int Rank = FMath::Clamp(FMath::CeilToInt(Percentile * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+    return Sorted[Rank];
+}
+
+FLD45Benchmark::FLD45Benchmark(UWorld* InWorld, const FSettings& InSettings)
+    : World(InWorld)
+    , Settings(InSettings)
+    , Random(InSettings.Seed)
+{
+}
+
+template <typename SetupType, typename FuncType>
+void FLD45Benchmark::Measure(const TCHAR* Name, int MapSize, SetupType Setup, FuncType Func)
+{
+    FSeries& Series = Results[Results.AddDefaulted()];
+    Series.Name = Name;
+    Series.MapSize = MapSize;
+    Series.NumEntities = GameMode ? GameMode->GetAllEntities().Num() : 0;
+    Series.SamplesMs.Reserve(Settings.Iterations);
+    Series.HeapAllocations.Reserve(Settings.Iterations);
+
+    FLD45CountingMalloc* CountingMalloc = FLD45CountingMalloc::Get();
+    for (int i = 0; i < Settings.Iterations; i++)
+    {
+        Setup();
+        const int StartAllocations = CountingMalloc ? CountingMalloc->GetNumAllocations() : 0;
+        double Start = FPlatformTime::Seconds();
+        Func();
+        if (GameMode)
+        {
+            //Listener work is part of the cost being measured
+            GameMode->FlushGameplayEvents();
+        }
+        Series.SamplesMs.Add((FPlatformTime::Seconds() - Start) * 1000.0);
+        Series.HeapAllocations.Add(CountingMalloc ? CountingMalloc->GetNumAllocations() - StartAllocations : 0);
+
+        //Each iteration stands in for a turn, its visuals are played out untimed
+        if (GameMode)
+        {
+            GameMode->SkipPresentation();
+            GameMode->ResetTurnArena();
+        }
+    }
+}
+
+template <typename FuncType>
+void FLD45Benchmark::MeasureTurn(const TCHAR* Name, int MapSize, FuncType Func)
+{
+    //Both runs start from the same board
+    FGameStateSnapshot Start;
+    if (Settings.CompareWithoutArena)
+    {
+        GameMode->CaptureSnapshot(Start);
+    }
+
+    Measure(Name, MapSize, NoSetup, Func);
+
+    //Scratch goes to the heap without an active arena, which is how turns allocated before it
+    if (Settings.CompareWithoutArena)
+    {
+        GameMode->RestoreSnapshot(Start, false);
+        FTurnArena* Arena = FTurnArena::GetActive();
+        FTurnArena::SetActive(nullptr);
+        Measure(*FString::Printf(TEXT("%s.NoArena"), Name), MapSize, NoSetup, Func);
+        FTurnArena::SetActive(Arena);
+    }
+}
+
+bool FLD45Benchmark::Run()
+{
+    FLD45CountingMalloc* CountingMalloc = FLD45CountingMalloc::Get();
+    if (CountingMalloc)
+    {
+        CountingMalloc->SetCounting(true);
+    }
+    else
+    {
+        UE_LOG(LogLD45Benchmark, Warning, TEXT("[Bench] Allocation counter isn't installed, heap allocations will read 0"));
+    }
+
+    const bool Result = RunAll();
+
+    if (CountingMalloc)
+    {
+        CountingMalloc->SetCounting(false);
+    }
+    return Result;
+}
+
+bool FLD45Benchmark::RunAll()
+{
+    Results.Reset();
+
+    GameMode = World ? Cast<AVoidGameMode>(World->GetAuthGameMode()) : nullptr;
+    if (!GameMode)
+    {
+        UE_LOG(LogLD45Benchmark, Error, TEXT("[Bench] No VoidGameMode in the current world"));
+        return false;
+    }
+
+    Map = GameMode->HexMapActor;
+    if (!Map)
+    {
+        TActorIterator<AHexMap> It(World);
+        Map = It ? *It : nullptr;
+    }
+
+    UPaperTileMap* SourceMap = Map && Map->GetRenderComponent() ? Map->GetRenderComponent()->TileMap : nullptr;
+    UHexMapData* SourceMapData = Map ? Map->GetMapData() : nullptr;
+    if (!SourceMap || SourceMap->TileLayers.Num() == 0)
+    {
+        UE_LOG(LogLD45Benchmark, Error, TEXT("[Bench] No tile map to build synthetic boards from"));
+        return false;
+    }
+
+    RunHexMath();
+
+    for (int Size : Settings.MapSizes)
+    {
+        RunMapSize(SourceMap, Size);
+    }
+
+    if (auto Player = Cast<AGamePlayerController>(World->GetFirstPlayerController()))
+    {
+        RunDeck(Player);
+    }
+
+    SetBoard(SourceMap);
+    if (SourceMapData)
+    {
+        Map->SetMapData(SourceMapData);
+        Map->FinishTransitions();
+    }
+    return true;
+}
+
+UPaperTileMap* FLD45Benchmark::MakeSyntheticMap(UPaperTileMap* Source, int Size)
+{
+    //Tiles are drawn from the source map so the synthetic board keeps its mix of terrain
+    TArray<FPaperTileInfo> Palette;
+    UPaperTileLayer* SourceLayer = Source->TileLayers[0];
+    for (int y = 0; y < SourceLayer->GetLayerHeight(); y++)
+    {
+        for (int x = 0; x < SourceLayer->GetLayerWidth(); x++)
+        {
+            FPaperTileInfo TileInfo = SourceLayer->GetCell(x, y);
+            if (TileInfo.IsValid())
+            {
+                Palette.Add(TileInfo);
+            }
+        }
+    }
+
+    UPaperTileMap* Synthetic = DuplicateObject<UPaperTileMap>(Source, GetTransientPackage());
+    Synthetic->ResizeMap(Size, Size);
+
+    UPaperTileLayer* Layer = Synthetic->TileLayers[0];
+    for (int y = 0; y < Size; y++)
+    {
+        for (int x = 0; x < Size; x++)
+        {
+            Layer->SetCell(x, y, Palette.Num() > 0 ? Palette[Random.RandHelper(Palette.Num())] : FPaperTileInfo());
+        }
+    }
+    return Synthetic;
+}
+
+void FLD45Benchmark::SetBoard(UPaperTileMap* TileMap)
+{
+    GameMode->DestroyAllEntities();
+    Map->SetTileMap(TileMap);
+    Map->FinishTransitions();
+}
+
+void FLD45Benchmark::PopulateEnemies(int Count)
+{
+    if (GameMode->EnemyTypes.Num() == 0)
+    {
+        return;
+    }
+
+    const int Width = Map->GetMapWidth();
+    const int Height = Map->GetMapHeight();
+    for (int Attempt = 0; Attempt < Count * 4 && GameMode->GetEnemies().Num() < Count; Attempt++)
+    {
+        FHexMapCoord Coord(Random.RandHelper(Width), Random.RandHelper(Height));
+        AHexCell* Cell = Map->GetOrLoadCell(Coord.x, Coord.y);
+        if (Cell && Cell->GetIsTraversable() && !Cell->GetOccupyingEntity())
+        {
+            GameMode->SpawnEntityOnCell(Cell, GameMode->EnemyTypes[Random.RandHelper(GameMode->EnemyTypes.Num())]);
+        }
+    }
+}
+
+void FLD45Benchmark::RunHexMath()
+{
+    //Summed into a checksum so the optimiser can't drop the work
+    int64 Checksum = 0;
+
+    Measure(TEXT("HexMathSpiral"), 0, NoSetup, [&Checksum]()
+    {
+        for (FHexSpiralIterator It(FHexAxial(), 32); It; ++It)
+        {
+            const FHexMapCoord Coord = HexMath::AxialToOffset(*It);
+            Checksum += HexMath::Distance(HexMath::OffsetToAxial(Coord), FHexAxial());
+        }
+    });
+
+    Measure(TEXT("HexMathRotate"), 0, NoSetup, [&Checksum]()
+    {
+        for (FHexSpiralIterator It(FHexAxial(), 32); It; ++It)
+        {
+            for (int Steps = 1; Steps < 6; Steps++)
+            {
+                Checksum += HexMath::Rotate(*It, Steps).Q;
+            }
+        }
+    });
+
+    Measure(TEXT("HexMathLine"), 0, NoSetup, [&Checksum]()
+    {
+        for (FHexRingIterator End(FHexAxial(), 32); End; ++End)
+        {
+            for (FHexLineIterator It(FHexAxial(), *End); It; ++It)
+            {
+                Checksum += (*It).R;
+            }
+        }
+    });
+
+    UE_LOG(LogLD45Benchmark, Log, TEXT("[Bench] HexMath checksum %lld"), Checksum);
+}
+
+void FLD45Benchmark::RunMapSize(UPaperTileMap* Source, int Size)
+{
+    UE_LOG(LogLD45Benchmark, Log, TEXT("[Bench] %dx%d"), Size, Size);
+
+    SetBoard(MakeSyntheticMap(Source, Size));
+
+    //A refresh while the last one is still transitioning would only be queued
+    auto ResetBoard = [this]()
+    {
+        Map->FinishTransitions();
+        GameMode->DestroyAllEntities();
+    };
+    Measure(TEXT("RefreshCells"), Size, ResetBoard, [this]()
+    {
+        Map->RefreshCells();
+    });
+    Map->FinishTransitions();
+
+    PopulateEnemies(FMath::Max(1, Size * Size / Settings.CellsPerEnemy));
+
+    MeasureTurn(TEXT("GetMoveLocations"), Size, [this]()
+    {
+        for (auto Enemy : GameMode->GetEnemies())
+        {
+            Enemy->GetMoveLocations();
+        }
+    });
+
+    MeasureTurn(TEXT("GetAttacks"), Size, [this]()
+    {
+        for (auto Enemy : GameMode->GetEnemies())
+        {
+            Enemy->GetAttacks();
+        }
+    });
+
+    //Every enemy's reach at once, against GetAttacks one entity at a time above
+    Measure(TEXT("AttackMask"), Size, NoSetup, [this]()
+    {
+        FHexBitboard Enemies = Map->GetFlagBoard(EHexCellFlags::Occupied);
+        Enemies.AndNot(Map->GetFlagBoard(EHexCellFlags::Friendly));
+        FHexBitboard Mask;
+        Map->GetAttackMask(Enemies, 3, Mask);
+    });
+
+    Measure(TEXT("ZoneOfControl"), Size, NoSetup, [this]()
+    {
+        FHexBitboard Zone;
+        Map->GetZoneOfControl(false, 2, Zone);
+    });
+
+    MeasureTurn(TEXT("AIMove"), Size, [this]()
+    {
+        auto Enemies = GameMode->GetEnemies();
+        for (auto Enemy : Enemies)
+        {
+            Enemy->AIMove();
+        }
+    });
+
+    //The native half of a loop, flow state transitions themselves are driven from blueprint
+    MeasureTurn(TEXT("GameLoop"), Size, [this]()
+    {
+        GameMode->SpawnEnemies();
+        GameMode->AddPendingSpawns();
+        GameMode->PlanEnemyTurn();
+        auto Enemies = GameMode->GetEnemies();
+        for (auto Enemy : Enemies)
+        {
+            if (IsValid(Enemy))
+            {
+                Enemy->AIResolveAttack();
+                Enemy->AIMove();
+                Enemy->AITelegraphAttack();
+            }
+        }
+    });
+
+    //What an undo push and an undo cost, the restore lands on the same board so every actor is reused
+    FGameStateSnapshot Snapshot;
+    TArray<uint8> SnapshotBytes;
+    Measure(TEXT("SnapshotCapture"), Size, NoSetup, [this, &Snapshot, &SnapshotBytes]()
+    {
+        GameMode->CaptureSnapshot(Snapshot);
+        Snapshot.Write(SnapshotBytes);
+    });
+
+    Measure(TEXT("SnapshotRestore"), Size, NoSetup, [this, &Snapshot, &SnapshotBytes]()
+    {
+        if (Snapshot.Read(SnapshotBytes))
+        {
+            GameMode->RestoreSnapshot(Snapshot, false);
+        }
+    });
+}
+
+void FLD45Benchmark::RunDeck(AGamePlayerController* Player)
+{
+    if (!Player->GetIsDeckLoaded())
+    {
+        UE_LOG(LogLD45Benchmark, Warning, TEXT("[Bench] Deck not loaded, skipping deck timings"));
+        return;
+    }
+
+    Player->ResetCards();
+
+    Measure(TEXT("DeckDrawDiscard"), 0, NoSetup, [Player]()
+    {
+        for (int i = 0; i < 5; i++)
+        {
+            Player->DrawCard();
+        }
+        Player->DiscardAll();
+    });
+
+    Measure(TEXT("DeckShuffle"), 0, NoSetup, [Player]()
+    {
+        while (Player->DrawCard())
+        {
+        }
+        Player->DiscardAll();
+        Player->StartShuffle();
+        Player->EndShuffle();
+    });
+
+    Player->ResetCards();
+}
+
+FString FLD45Benchmark::ToJson() const
+{
+    FString Json = FString::Printf(TEXT("{\n  \"iterations\": %d,\n  \"seed\": %d,\n  \"config\": \"%s\",\n  \"results\": [\n"),
+        Settings.Iterations, Settings.Seed, EBuildConfigurations::ToString(FApp::GetBuildConfiguration()));
+
+    for (int i = 0; i < Results.Num(); i++)
+    {
+        const FSeries& Series = Results[i];
+        TArray<double> Sorted = Series.SamplesMs;
+        Sorted.Sort();
+
+        double Total = 0.0;
+        for (double Sample : Sorted)
+        {
+            Total += Sample;
+        }
+
+        TArray<int> SortedAllocations = Series.HeapAllocations;
+        SortedAllocations.Sort();
+
+        if (Sorted.Num() > 0)
+        {
+            Json += FString::Printf(TEXT("    { \"name\": \"%s\", \"mapSize\": %d, \"entities\": %d, \"samples\": %d, ")
+                TEXT("\"minMs\": %.4f, \"p50Ms\": %.4f, \"p90Ms\": %.4f, \"p99Ms\": %.4f, \"maxMs\": %.4f, \"meanMs\": %.4f, ")
+                TEXT("\"heapAllocsMin\": %d, \"heapAllocsP50\": %d, \"heapAllocsMax\": %d }%s\n"),
+                *Series.Name, Series.MapSize, Series.NumEntities, Sorted.Num(),
+                Sorted[0], NearestRank(Sorted, 0.5), NearestRank(Sorted, 0.9), NearestRank(Sorted, 0.99), Sorted.Last(), Total / Sorted.Num(),
+                SortedAllocations[0], SortedAllocations[SortedAllocations.Num() / 2], SortedAllocations.Last(),
+                i + 1 < Results.Num() ? TEXT(",") : TEXT(""));
+        }
+    }
+
+    Json += TEXT("  ]\n}\n");
+    return Json;
+}
+
+bool FLD45Benchmark::GetPercentileMs(const FString& Name, int MapSize, double Percentile, double& OutMs) const
+{
+    for (const FSeries& Series : Results)
+    {
+        if (Series.Name == Name && Series.MapSize == MapSize && Series.SamplesMs.Num() > 0)
+        {
+            TArray<double> Sorted = Series.SamplesMs;
+            Sorted.Sort();
+            OutMs = NearestRank(Sorted, Percentile);
+            return true;
+        }
+    }
+    return false;
+}
+
+FString FLD45Benchmark::SaveReport() const
+{
+    FString Path = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Benchmarks"), FString::Printf(TEXT("LD45Bench-%s.json"), *FDateTime::Now().ToString()));
+    if (FFileHelper::SaveStringToFile(ToJson(), *Path))
+    {
+        return Path;
+    }
+    return FString();
+}
+
+//LD45.Bench [Iterations] [quit]
+static void RunBenchmarkCommand(const TArray<FString>& Args, UWorld* World)
+{
+    FLD45Benchmark::FSettings Settings;
+    bool QuitWhenDone = false;
+    for (const FString& Arg : Args)
+    {
+        if (Arg.IsNumeric())
+        {
+            Settings.Iterations = FMath::Max(1, FCString::Atoi(*Arg));
+        }
+        else if (Arg == TEXT("quit"))
+        {
+            QuitWhenDone = true;
+        }
+    }
+
+    FLD45Benchmark Benchmark(World, Settings);
+    if (Benchmark.Run())
+    {
+        FString Path = Benchmark.SaveReport();
+        UE_LOG(LogLD45Benchmark, Display, TEXT("[Bench] Report written to %s"), *Path);
+    }
+
+    if (QuitWhenDone)
+    {
+        FPlatformMisc::RequestExit(false);
+    }
+}
+
+static FAutoConsoleCommandWithWorldAndArgs LD45BenchCommand(
+    TEXT("LD45.Bench"),
+    TEXT("Times map, AI and deck hot paths on synthetic boards and writes percentiles to Saved/Benchmarks. Usage: LD45.Bench [Iterations] [quit]"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunBenchmarkCommand));
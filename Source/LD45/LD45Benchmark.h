@@ -0,0 +1,91 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+class UPaperTileMap;
+class AHexMap;
+class AVoidGameMode;
+class AGamePlayerController;
+
+/**
+ * Times the hex maths, map, AI and deck hot paths over synthetic boards and reports percentiles and
+ * game thread heap allocations per sample as JSON.
+ * Runs against the live world so the game mode, map and deck blueprints are the real ones, e.g.
+ *   UE4Editor LD45 -game -nullrhi -unattended -ExecCmds="LD45.Bench 20 quit"
+ * The LD45.Bench automation test runs the same series and checks them against the budgets in DefaultGame.ini.
+ * The current board is replaced while it runs and the original tile map is restored afterwards.
+ */
+class LD45_API FLD45Benchmark
+{
+public:
+
+    struct FSettings
+    {
+        TArray<int> MapSizes = { 16, 32, 64, 128, 256 };
+        int Iterations = 20;
+        int Seed = 45;
+        //One enemy per this many cells
+        int CellsPerEnemy = 64;
+        //Runs the turn series a second time with the turn arena off, as <Series>.NoArena
+        bool CompareWithoutArena = true;
+    };
+
+    FLD45Benchmark(UWorld* InWorld, const FSettings& InSettings);
+
+    //Puts the game thread allocation counter in front of GMalloc, once at module startup, outside shipping builds
+    static void InstallAllocationCounter();
+
+    //Returns false if the world isn't running an LD45 game
+    bool Run();
+
+    FString ToJson() const;
+
+    //Percentile of one series' samples in milliseconds, false if the series didn't run
+    bool GetPercentileMs(const FString& Name, int MapSize, double Percentile, double& OutMs) const;
+
+    //Writes to Saved/Benchmarks and returns the file path, empty on failure
+    FString SaveReport() const;
+
+private:
+
+    struct FSeries
+    {
+        FString Name;
+        int MapSize;
+        int NumEntities;
+        TArray<double> SamplesMs;
+        //Game thread heap allocations per sample
+        TArray<int> HeapAllocations;
+    };
+
+    //Setup runs before every sample and is not timed
+    template <typename SetupType, typename FuncType>
+    void Measure(const TCHAR* Name, int MapSize, SetupType Setup, FuncType Func);
+
+    //Measure for per turn work, plus the same again without the turn arena when comparing
+    template <typename FuncType>
+    void MeasureTurn(const TCHAR* Name, int MapSize, FuncType Func);
+
+    bool RunAll();
+
+    UPaperTileMap* MakeSyntheticMap(UPaperTileMap* Source, int Size);
+    void SetBoard(UPaperTileMap* TileMap);
+    void PopulateEnemies(int Count);
+
+    //Coordinate maths on its own, no board involved
+    void RunHexMath();
+    void RunMapSize(UPaperTileMap* Source, int Size);
+    void RunDeck(AGamePlayerController* Player);
+
+private:
+
+    UWorld* World;
+    FSettings Settings;
+    FRandomStream Random;
+
+    AVoidGameMode* GameMode = nullptr;
+    AHexMap* Map = nullptr;
+
+    TArray<FSeries> Results;
+};
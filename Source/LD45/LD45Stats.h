@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+#if defined(__has_include)
+#if __has_include("ProfilingDebugging/CpuProfilerTrace.h")
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#endif
+#endif
+
+#ifndef CPUPROFILERTRACE_ENABLED
+#define CPUPROFILERTRACE_ENABLED 0
+#endif
+
+//Cycle counter for `stat LD45` that also opens a named scope for Insights where the engine has the CPU profiler trace
+class FLD45ScopeCycleCounter : public FScopeCycleCounter
+{
+public:
+    FORCEINLINE FLD45ScopeCycleCounter(TStatId StatId, const TCHAR* Name)
+        : FScopeCycleCounter(StatId)
+    {
+#if CPUPROFILERTRACE_ENABLED
+        FCpuProfilerTrace::OutputBeginDynamicEvent(Name);
+#endif
+    }
+
+    FORCEINLINE ~FLD45ScopeCycleCounter()
+    {
+#if CPUPROFILERTRACE_ENABLED
+        FCpuProfilerTrace::OutputEndEvent();
+#endif
+    }
+};
+
+//A single declaration, so it behaves like SCOPE_CYCLE_COUNTER wherever a statement can go
+#define LD45_SCOPE_CYCLE_COUNTER(Stat) \
+    FLD45ScopeCycleCounter ANONYMOUS_VARIABLE(LD45CycleCount_)(GET_STATID(Stat), TEXT(#Stat))
+
+DECLARE_STATS_GROUP(TEXT("LD45"), STATGROUP_LD45, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RefreshCells"), STAT_LD45_RefreshCells, STATGROUP_LD45, LD45_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GetMoveLocations"), STAT_LD45_GetMoveLocations, STATGROUP_LD45, LD45_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GetAttacks"), STAT_LD45_GetAttacks, STATGROUP_LD45, LD45_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("AIMove"), STAT_LD45_AIMove, STATGROUP_LD45, LD45_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("AITelegraphAttack"), STAT_LD45_AITelegraphAttack, STATGROUP_LD45, LD45_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("AIResolveAttack"), STAT_LD45_AIResolveAttack, STATGROUP_LD45, LD45_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("PlanEnemyTurn"), STAT_LD45_PlanEnemyTurn, STATGROUP_LD45, LD45_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("EnemyTurnSteps"), STAT_LD45_EnemyTurnSteps, STATGROUP_LD45, LD45_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("EventDispatch"), STAT_LD45_EventDispatch, STATGROUP_LD45, LD45_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Presentation"), STAT_LD45_Presentation, STATGROUP_LD45, LD45_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Snapshot"), STAT_LD45_Snapshot, STATGROUP_LD45, LD45_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SpawnEnemies"), STAT_LD45_SpawnEnemies, STATGROUP_LD45, LD45_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("AddPendingSpawns"), STAT_LD45_AddPendingSpawns, STATGROUP_LD45, LD45_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FlowState Broadcast"), STAT_LD45_FlowStateBroadcast, STATGROUP_LD45, LD45_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ApplyBoardCommands"), STAT_LD45_ApplyBoardCommands, STATGROUP_LD45, LD45_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FieldOfView"), STAT_LD45_FieldOfView, STATGROUP_LD45, LD45_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Influence"), STAT_LD45_Influence, STATGROUP_LD45, LD45_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Highlight"), STAT_LD45_Highlight, STATGROUP_LD45, LD45_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("CellTransforms"), STAT_LD45_CellTransforms, STATGROUP_LD45, LD45_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Animation"), STAT_LD45_Animation, STATGROUP_LD45, LD45_API);
+
+//Reset at GameLoopStart so they read as per turn totals
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Cells Touched (turn)"), STAT_LD45_CellsTouched, STATGROUP_LD45, LD45_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Entities Evaluated (turn)"), STAT_LD45_EntitiesEvaluated, STATGROUP_LD45, LD45_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Arena Allocations (turn)"), STAT_LD45_ArenaAllocations, STATGROUP_LD45, LD45_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Arena Bytes (turn)"), STAT_LD45_ArenaBytes, STATGROUP_LD45, LD45_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Events Queued (turn)"), STAT_LD45_EventsQueued, STATGROUP_LD45, LD45_API);
@@ -4,6 +4,13 @@
 #include "Engine/World.h"
 #include "Kismet/KismetSystemLibrary.h"
 #include "VoidGameMode.h"
+#include "HexMath.h"
+#include "HexBitboard.h"
+#include "HexCoordSet.h"
+#include "Algo/BinarySearch.h"
+#include "HexAnimationScheduler.h"
+#include "GameplayEventQueue.h"
+#include "LD45Stats.h"
 
 AMapEntity::AMapEntity()
 {
@@ -11,6 +18,11 @@ AMapEntity::AMapEntity()
     MoveDistance = 3;
     AttackDistance = 1;
     MaxHealth = 1;
+
+    MoveTweenDuration = 0.0f;
+    TickOnlyWhileAnimating = false;
+    AttackPresentDuration = 0.25f;
+    DeathPresentDuration = 0.25f;
 }
 
 void AMapEntity::BeginPlay()
@@ -18,22 +30,23 @@ void AMapEntity::BeginPlay()
     Health = MaxHealth;
 
 	Super::BeginPlay();
+
+    if (TickOnlyWhileAnimating)
+    {
+        SetActorTickEnabled(false);
+    }
 }
 
 void AMapEntity::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
     Super::EndPlay(EndPlayReason);
 
-    if (MapCell && MapCell->GetOwningMap())
+    LeaveMapCell();
+
+    UWorld* World = GetWorld();
+    if (auto VoidGameMode = World ? Cast<AVoidGameMode>(World->GetAuthGameMode()) : nullptr)
     {
-        MapCell->SetOccupyingEntity(nullptr);
-        for (const auto& Coord : PendingAttackInfo.Locations)
-        {
-            if (auto Cell = MapCell->GetOwningMap()->GetCell(Coord.x, Coord.y))
-            {
-                Cell->ShowEnemyAttack(false);
-            }
-        }
+        VoidGameMode->RemoveTelegraphedAttack(this);
     }
 }
 
@@ -46,19 +59,136 @@ bool AMapEntity::MoveToMapCell(AHexCell* Cell)
             MapCell->SetOccupyingEntity(nullptr);
         }
         auto PreviousCell = MapCell;
+        const FVector PreviousLocation = GetActorLocation();
         MapCell = Cell;
         MapCell->SetOccupyingEntity(this);
-        this->AttachToActor(MapCell, FAttachmentTransformRules::SnapToTargetNotIncludingScale);
-        OnMove.Broadcast(this, PreviousCell, Cell);
+        auto Map = MapCell->GetOwningMap();
+        SnapToMapCell();
+        if (PreviousCell && IsPresentationDeferred())
+        {
+            //Stay put until the presentation timeline plays the move
+            SetActorLocation(PreviousLocation);
+        }
+        else if (PreviousCell && MoveTweenDuration > 0.0f)
+        {
+            TweenFrom(PreviousLocation);
+        }
+        if (Map)
+        {
+            Map->UpdateEntityInfluence(this);
+        }
+        if (auto Queue = FGameplayEventQueue::Get(this))
+        {
+            Queue->PushMove(this, PreviousCell, Cell);
+        }
+        else
+        {
+            OnMove.Broadcast(this, PreviousCell, Cell);
+        }
         return true;
     }
     return false;
 }
 
+void AMapEntity::SnapToMapCell()
+{
+    auto Map = MapCell->GetOwningMap();
+    if (Map && Map->GetUseFlatHierarchy())
+    {
+        //The map places us with the cell when it moves
+        DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+        SetActorLocationAndRotation(MapCell->GetActorLocation(), MapCell->GetActorQuat(), false, nullptr, ETeleportType::TeleportPhysics);
+    }
+    else
+    {
+        this->AttachToActor(MapCell, FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+    }
+}
+
+void AMapEntity::LeaveMapCell()
+{
+    if (MapCell && MapCell->GetOwningMap())
+    {
+        //Restores can put someone else here first
+        if (MapCell->GetOccupyingEntity() == this)
+        {
+            MapCell->SetOccupyingEntity(nullptr);
+        }
+        MapCell->GetOwningMap()->RemoveEntityInfluence(this);
+    }
+    MapCell = nullptr;
+}
+
+void AMapEntity::RestoreState(AHexCell* Cell, int NewHealth, int NewMaxHealth, bool HasAttackPending)
+{
+    LeaveMapCell();
+
+    if (auto Scheduler = UHexAnimationScheduler::GetAnimationScheduler(this))
+    {
+        Scheduler->CancelAll(this);
+    }
+
+    MaxHealth = NewMaxHealth;
+    Health = FMath::Clamp(NewHealth, 0, MaxHealth);
+    AIHasAttackPending = HasAttackPending;
+
+    MapCell = Cell;
+    if (MapCell)
+    {
+        MapCell->SetOccupyingEntity(this);
+        SnapToMapCell();
+        if (auto Map = MapCell->GetOwningMap())
+        {
+            Map->UpdateEntityInfluence(this);
+        }
+    }
+
+    //Straight to blueprint so health displays catch up, a restore isn't gameplay
+    HealthChanged();
+    OnHealthChanged.Broadcast(this);
+}
+
+void AMapEntity::TweenFrom(const FVector& FromLocation, AHexCell* ToCell)
+{
+    if (auto Scheduler = UHexAnimationScheduler::GetAnimationScheduler(this))
+    {
+        //Chases the cell rather than a fixed point so it lands right even if the cell is still animating
+        Scheduler->CancelAll(this);
+        SetActorLocation(FromLocation);
+        TWeakObjectPtr<AHexCell> TargetCell = ToCell;
+        Scheduler->PlayTimed(this, MoveTweenDuration, [this, FromLocation, TargetCell](float Alpha)
+        {
+            AHexCell* Target = TargetCell.IsValid() ? TargetCell.Get() : MapCell;
+            if (Target)
+            {
+                SetActorLocation(FMath::Lerp(FromLocation, Target->GetActorLocation(), FMath::InterpEaseInOut(0.0f, 1.0f, Alpha, 2.0f)));
+            }
+        }, TickOnlyWhileAnimating);
+    }
+}
+
+void AMapEntity::PresentMove(const FVector& FromLocation, AHexCell* ToCell, bool Animate)
+{
+    if (Animate && MoveTweenDuration > 0.0f && UHexAnimationScheduler::GetAnimationScheduler(this))
+    {
+        TweenFrom(FromLocation, ToCell);
+    }
+    else if (ToCell)
+    {
+        if (auto Scheduler = UHexAnimationScheduler::GetAnimationScheduler(this))
+        {
+            Scheduler->CancelAll(this);
+        }
+        SetActorLocation(ToCell->GetActorLocation());
+    }
+}
+
 bool AMapEntity::PerformAttack(const FMapAttackInfo& AttackInfo)
 {
     if (ensure(MapCell) && MapCell->GetOwningMap() && AttackInfo.Locations.Num() > 0)
     {
+        auto Queue = FGameplayEventQueue::Get(this);
+        int NumHits = 0;
         for (const auto& Coord : AttackInfo.Locations)
         {
             if (auto Cell = MapCell->GetOwningMap()->GetCell(Coord.x, Coord.y))
@@ -67,10 +197,20 @@ bool AMapEntity::PerformAttack(const FMapAttackInfo& AttackInfo)
                 {
                     FDamageEvent DamageEvent;
                     OtherEntity->TakeDamage(AttackInfo.Damage, DamageEvent, nullptr, AttackInfo.Source);
-                    OnAttack.Broadcast(this, AttackInfo);
+                    NumHits++;
+                    if (!Queue)
+                    {
+                        OnAttack.Broadcast(this, AttackInfo);
+                    }
                 }
             }
         }
+
+        //One record for the whole attack however many it hit
+        if (Queue && NumHits > 0)
+        {
+            Queue->PushAttack(this, AttackInfo, NumHits);
+        }
         return true;
     }
     return false;
@@ -80,15 +220,24 @@ bool AMapEntity::TryPerformAttack(AHexCell* Cell, const TArray<FMapAttackInfo>&
 {
     if (Cell)
     {
+        //Attacks are a few short rays, hashed rather than a board sized bitset
+        const FHexMapCoord& Target = Cell->GetMapCoord();
+        FHexCoordSet AttackLocations;
+        TArray<int, TInlineAllocator<6>> AttackEnds;
         for (const auto& Attack : Attacks)
         {
             for (const auto& Coord : Attack.Locations)
             {
-                if (Coord == Cell->GetMapCoord())
-                {
-                    return PerformAttack(Attack);
-                }
+                AttackLocations.Add(Coord);
             }
+            AttackEnds.Add(AttackLocations.Num());
+        }
+
+        //The first attack to add a location owns it, same as scanning the attacks in order
+        const int Element = AttackLocations.Find(Target);
+        if (Element != INDEX_NONE)
+        {
+            return PerformAttack(Attacks[Algo::UpperBound(AttackEnds, Element)]);
         }
     }
     return false;
@@ -117,167 +266,187 @@ bool AMapEntity::Kill()
 
 TArray<FHexMapCoord> AMapEntity::GetMoveLocations() const
 {
-    TArray<FHexMapCoord> Result;
+    TTurnArray<FHexMapCoord> Locations;
+    GatherMoveLocations(Locations);
+
+    return TArray<FHexMapCoord>(Locations);
+}
+
+void AMapEntity::GatherMoveLocations(TTurnArray<FHexMapCoord>& OutLocations) const
+{
+    LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_GetMoveLocations);
+
+    OutLocations.Reset();
     if (MapCell)
     {
         if (auto Map = MapCell->GetOwningMap())
         {
-            Result.Reserve(1 + ((MoveDistance - 1) * (MoveDistance * 6)));
-            TArray<FHexMapCoord> WorkingSet = { MapCell->GetMapCoord() };
-            TArray<FHexMapCoord> AdjacentSet;
+            const FHexMapCoord& Origin = MapCell->GetMapCoord();
 
-            for (int i = 0; i < MoveDistance; i++)
-            {
-                AdjacentSet.Reset();
-                for (const auto& Coord : WorkingSet)
-                {
-                    Map->GetAdjacentHexCoords(Coord, AdjacentSet);
-                }
-                for (const auto& AdjacentCoord : AdjacentSet)
-                {
-                    WorkingSet.AddUnique(AdjacentCoord);
-                }
-            }
+            //Range is a plain radius, terrain only decides where we can end up
+            THexBitboard<FTurnArenaAllocator> Reachable;
+            Reachable.Init(Map->GetMapWidth(), Map->GetMapHeight());
+            Reachable.Set(Origin);
+            Reachable.Dilate(MoveDistance, Origin.y - MoveDistance, Origin.y + MoveDistance);
+            Reachable.And(Map->GetFlagBoard(EHexCellFlags::Traversable));
+            Reachable.AndNot(Map->GetFlagBoard(EHexCellFlags::Occupied));
 
-            for (const auto& Coord : WorkingSet)
-            {
-                auto Cell = Map->GetCell(Coord.x, Coord.y);
-                if (Cell && Cell->GetIsTraversable(this))
-                {
-                    Result.Emplace(Coord);
-                }
-            }            
+            OutLocations.Reserve(HexMath::SpiralCount(MoveDistance));
+            Reachable.GetCoords(OutLocations);
+
+            INC_DWORD_STAT_BY(STAT_LD45_CellsTouched, OutLocations.Num());
         }
     }
-    return Result;
+}
+
+void AMapEntity::GatherMoveLocations(FHexCoordSet& OutLocations) const
+{
+    TTurnArray<FHexMapCoord> Locations;
+    GatherMoveLocations(Locations);
+
+    OutLocations.Reset();
+    OutLocations.Reserve(Locations.Num());
+    for (const auto& Location : Locations)
+    {
+        OutLocations.Add(Location);
+    }
 }
 
 TArray<FMapAttackInfo> AMapEntity::GetAttacks() const
 {
+    LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_GetAttacks);
+
     TArray<FMapAttackInfo> Result;
 
     if (MapCell && AttackDistance > 0)
     {
-        if (auto Map = MapCell->GetOwningMap())
+        Result.Reserve(6);
+
+        FMapAttackInfo AttackInfo;
+        AttackInfo.Locations.Reserve(AttackDistance);
+
+        for (int Dir = 0; Dir < 6; Dir++)
         {
-            Result.Reserve(AttackDistance * 6);
-            const auto& SourceCoord = MapCell->GetMapCoord();
+            if (GetAttackInDirection(Dir, AttackInfo))
+            {
+                Result.Emplace(AttackInfo);
+                INC_DWORD_STAT_BY(STAT_LD45_CellsTouched, AttackInfo.Locations.Num());
+            }
+        }
+    }
 
-            const auto& Directions = GetDirectionsAt(SourceCoord);
+    return Result;
+}
 
-            FMapAttackInfo AttackInfo;
-            AttackInfo.Damage = 1;
-            AttackInfo.Source = const_cast<AMapEntity*>(this);
-            AttackInfo.Locations.Reserve(AttackDistance);
+bool AMapEntity::GetAttackInDirection(int Direction, FMapAttackInfo& OutAttackInfo) const
+{
+    OutAttackInfo.Locations.Reset();
+    OutAttackInfo.Hits.Reset();
+    OutAttackInfo.Damage = 1;
+    OutAttackInfo.Source = const_cast<AMapEntity*>(this);
 
-            for (int Dir = 0; Dir < Directions.Num(); Dir++)
+    if (MapCell && AttackDistance > 0)
+    {
+        if (auto Map = MapCell->GetOwningMap())
+        {
+            FHexMapCoord AttackCoord = MapCell->GetMapCoord();
+            for (int i = 0; i < AttackDistance; i++)
             {
-                AttackInfo.Locations.Reset();
-                AttackInfo.Hits.Reset();
-
-                FHexMapCoord AttackCoord = SourceCoord;
-                for (int i = 0; i < AttackDistance; i++)
+                if (Map->GetNextCoordInDirection(AttackCoord, Direction, AttackCoord))
                 {
-                    if (Map->GetNextCoordInDirection(AttackCoord, Dir, AttackCoord))
+                    //Packed flags first so the ray doesn't stream in cells it only passes over
+                    const uint8 Flags = Map->GetCellFlags()[Map->GetCellIndex(AttackCoord)];
+                    if (Flags & EHexCellFlags::Exists)
                     {
-                        if (auto Cell = Map->GetCell(AttackCoord.x, AttackCoord.y))
+                        if (Flags & EHexCellFlags::Traversable)
                         {
-                            if (Cell->GetIsAttackable(this))
-                            {
-                                AttackInfo.Locations.Add(AttackCoord);
+                            OutAttackInfo.Locations.Add(AttackCoord);
 
-                                //Terminate attack if we hit something
-                                if (auto HitEntity = Cell->GetOccupyingEntity())
+                            //Terminate attack if we hit something
+                            if (Flags & EHexCellFlags::Occupied)
+                            {
+                                auto Cell = Map->GetCell(AttackCoord.x, AttackCoord.y);
+                                if (auto HitEntity = Cell ? Cell->GetOccupyingEntity() : nullptr)
                                 {
-                                    AttackInfo.Hits.Add(HitEntity);
-                                    break;
+                                    OutAttackInfo.Hits.Add(HitEntity);
                                 }
-                            }
-                            else //Terminate if not attackable
-                            {
                                 break;
                             }
                         }
-                    }
-                    else //terminate if out of map bounds
-                    {
-                        break;
+                        else //Terminate if not attackable
+                        {
+                            break;
+                        }
                     }
                 }
-
-                if (AttackInfo.Locations.Num() > 0)
+                else //terminate if out of map bounds
                 {
-                    Result.Emplace(AttackInfo);
+                    break;
                 }
             }
         }
     }
 
-    return Result;
+    return OutAttackInfo.Locations.Num() > 0;
 }
 
 bool AMapEntity::AIMove()
 {
+    LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_AIMove);
+    INC_DWORD_STAT(STAT_LD45_EntitiesEvaluated);
+
     if (MapCell == nullptr) return false;
 
     auto Map = MapCell->GetOwningMap();
     if (Map == nullptr) return false;
 
-    TArray<FHexMapCoord> Path;
-
-    struct FPotentialMove
-    {
-        AHexCell* Cell;
-        float Weight;
-    };
-
-    TArray<FPotentialMove> WorkingSet;
-
-    auto MoveLocations = GetMoveLocations();
-    for (int i = 0; i < MoveLocations.Num(); i++)
+    //Follow the lookahead plan when there is one
+    FHexMapCoord PlannedMove;
+    int PlannedAttack = INDEX_NONE;
+    auto VoidGameMode = Cast<AVoidGameMode>(GetWorld()->GetAuthGameMode());
+    if (VoidGameMode && VoidGameMode->GetPlannedEnemyAction(this, PlannedMove, PlannedAttack))
     {
-        if (auto Cell = Map->GetCell(MoveLocations[i].x, MoveLocations[i].y))
+        if (PlannedMove == MapCell->GetMapCoord() || MoveToMapCell(Map->GetOrLoadCell(PlannedMove.x, PlannedMove.y)))
         {
-            float Weight = 0.0f;
+            return true;
+        }
+        //Board has diverged from the plan, fall back to influence
+    }
 
-            //Distance to targets
-            float MinDistanceToTargetSq = FLT_MAX;
-            if (auto VoidGameMode = Cast<AVoidGameMode>(GetWorld()->GetAuthGameMode()))
-            {
-                for (auto Friendly : VoidGameMode->GetFriendlies())
-                {
-                    float DistSq = FVector::Dist2D(Cell->GetActorLocation(), Friendly->GetActorLocation());
-                    if (Friendly->GetIsHighValue())
-                    {
-                        DistSq *= 0.5f;
-                    }
-                    if (DistSq < MinDistanceToTargetSq)
-                    {
-                        MinDistanceToTargetSq = DistSq;
-                    }
-                }
-            }
+    //Influence already folds in distance to targets, friendly threat and telegraphed attacks
+    const FHexMapCoord* BestLocation = nullptr;
+    float BestScore = -FLT_MAX;
+    int NumTied = 0;
 
-            //TODO: Consider attacks?
-            Weight = (int)MinDistanceToTargetSq;
+    //Scored from the packed grid, only the winner's cell actor is needed
+    TTurnArray<FHexMapCoord> MoveLocations;
+    GatherMoveLocations(MoveLocations);
+    for (const auto& Location : MoveLocations)
+    {
+        float Score = Map->GetEnemyMoveScore(Location);
 
-            WorkingSet.Add({ Cell, Weight });
+        if (Score > BestScore + KINDA_SMALL_NUMBER)
+        {
+            BestLocation = &Location;
+            BestScore = Score;
+            NumTied = 1;
+        }
+        else if (Score >= BestScore - KINDA_SMALL_NUMBER && AVoidGameMode::RandRange(this, 0, NumTied++) == 0)
+        {
+            BestLocation = &Location; //Uniform pick between equally good cells
+        }
 
 #if UE_BUILD_DEVELOPMENT
-            UKismetSystemLibrary::DrawDebugString(this, Cell->GetActorLocation(), FString::Format(TEXT("{0}"), { Weight }), nullptr, FLinearColor::Red, 1.0f);
-#endif
+        if (auto Cell = Map->GetCells()[Map->GetCellIndex(Location)])
+        {
+            UKismetSystemLibrary::DrawDebugString(this, Cell->GetActorLocation(), FString::Printf(TEXT("%.2f"), Score), nullptr, FLinearColor::Red, 1.0f);
         }
+#endif
     }
 
-    WorkingSet.Sort([](const FPotentialMove& A, const FPotentialMove& B)
+    if (BestLocation)
     {
-        return A.Weight < B.Weight;
-    });
-
-    if (WorkingSet.Num() > 0)
-    {
-        FPotentialMove Move = WorkingSet[FMath::RandRange(0, FMath::Min(WorkingSet.Num() - 1, 2))];
-        MoveToMapCell(Move.Cell);
+        MoveToMapCell(Map->GetOrLoadCell(BestLocation->x, BestLocation->y));
         return true;
     }
 
@@ -286,6 +455,9 @@ bool AMapEntity::AIMove()
 
 bool AMapEntity::AITelegraphAttack()
 {
+    LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_AITelegraphAttack);
+    INC_DWORD_STAT(STAT_LD45_EntitiesEvaluated);
+
     AIHasAttackPending = false;
 
     if (MapCell == nullptr) return false;
@@ -293,34 +465,44 @@ bool AMapEntity::AITelegraphAttack()
     auto Map = MapCell->GetOwningMap();
     if (Map == nullptr) return false;
 
-    //Find attacks that hit
-    auto Attacks = GetAttacks();
-    TArray<FMapAttackInfo> AttacksThatHit;
-    for(const auto& Attack : Attacks)
+    auto HitsFriendly = [](const FMapAttackInfo& Attack)
+    {
+        return Attack.Hits.ContainsByPredicate([](const AMapEntity* HitEntity) { return HitEntity && HitEntity->GetIsFriendly(); });
+    };
+
+    FMapAttackInfo Attack;
+    Attack.Locations.Reserve(AttackDistance);
+
+    //Planned attacks only stand if they still hit
+    FHexMapCoord PlannedMove;
+    int PlannedAttack = INDEX_NONE;
+    auto VoidGameMode = Cast<AVoidGameMode>(GetWorld()->GetAuthGameMode());
+    if (VoidGameMode && VoidGameMode->GetPlannedEnemyAction(this, PlannedMove, PlannedAttack) && PlannedAttack != INDEX_NONE)
     {
-        for(auto HitEntity : Attack.Hits)
+        if (GetAttackInDirection(PlannedAttack, Attack) && HitsFriendly(Attack))
         {
-            if (HitEntity && HitEntity->GetIsFriendly())
-            {
-                AttacksThatHit.Add(Attack);
-                break;
-            }
+            AIHasAttackPending = true;
+            VoidGameMode->AddTelegraphedAttack(this, Attack);
+            return true;
         }
     }
 
-    if (AttacksThatHit.Num() > 0)
+    //Find attacks that hit, only the chosen one is kept
+    TArray<int, TInlineAllocator<6>> DirectionsThatHit;
+    for (int Dir = 0; Dir < 6; Dir++)
     {
-        AIHasAttackPending = true;
-        PendingAttackInfo = AttacksThatHit[FMath::RandRange(0, AttacksThatHit.Num() - 1)];
-
-        for (const auto& Coord : PendingAttackInfo.Locations)
+        if (GetAttackInDirection(Dir, Attack) && HitsFriendly(Attack))
         {
-            if (auto Cell = Map->GetCell(Coord.x, Coord.y))
-            {
-                Cell->ShowEnemyAttack(true);
-            }
+            DirectionsThatHit.Add(Dir);
         }
+        INC_DWORD_STAT_BY(STAT_LD45_CellsTouched, Attack.Locations.Num());
+    }
 
+    if (DirectionsThatHit.Num() > 0 && VoidGameMode)
+    {
+        AIHasAttackPending = true;
+        GetAttackInDirection(DirectionsThatHit[AVoidGameMode::RandRange(this, 0, DirectionsThatHit.Num() - 1)], Attack);
+        VoidGameMode->AddTelegraphedAttack(this, Attack);
         return true;
     }
 
@@ -329,6 +511,8 @@ bool AMapEntity::AITelegraphAttack()
 
 bool AMapEntity::AIResolveAttack()
 {
+    LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_AIResolveAttack);
+
     if (AIHasAttackPending)
     {
         if (MapCell == nullptr) return false;
@@ -338,17 +522,14 @@ bool AMapEntity::AIResolveAttack()
 
         AIHasAttackPending = false;
 
-        for (const auto& Coord : PendingAttackInfo.Locations)
+        //The telegraph stays lit until every enemy has resolved, the game mode clears them together
+        FMapAttackInfo Attack;
+        auto VoidGameMode = Cast<AVoidGameMode>(GetWorld()->GetAuthGameMode());
+        if (VoidGameMode && VoidGameMode->GetTelegraphedAttack(this, Attack))
         {
-            if (auto Cell = Map->GetCell(Coord.x, Coord.y))
-            {
-                Cell->ShowEnemyAttack(false);
-            }
+            PerformAttack(Attack);
+            return true;
         }
-
-        PerformAttack(PendingAttackInfo);
-
-        return true;
     }
     return false;
 }
@@ -359,14 +540,100 @@ void AMapEntity::SetHealth(int NewHealth)
     if (NewHealth != Health)
     {
         Health = NewHealth;
-        HealthChanged();
-        OnHealthChanged.Broadcast(this);
+
+        //With the timeline the native events run as it plays them, in a board command batch they run at its end.
+        //Blueprint Death destroys the actor
+        UWorld* World = GetWorld();
+        auto VoidGameMode = World ? Cast<AVoidGameMode>(World->GetAuthGameMode()) : nullptr;
+        const bool Batched = VoidGameMode && VoidGameMode->GetIsApplyingBoardCommands();
+        const bool Deferred = Batched || IsPresentationDeferred();
+        if (Batched)
+        {
+            VoidGameMode->DeferEntityHealthEvents(this);
+        }
+        else if (!Deferred)
+        {
+            HealthChanged();
+        }
+
+        auto Queue = FGameplayEventQueue::Get(this);
+        if (Queue)
+        {
+            Queue->PushHealthChanged(this);
+        }
+        else
+        {
+            OnHealthChanged.Broadcast(this);
+        }
 
         if (Health == 0)
         {
-            Death();
-            OnDeath.Broadcast(this);
+            if (Deferred)
+            {
+                //Off the board now, the actor stays until its death has played
+                LeaveMapCell();
+                if (VoidGameMode)
+                {
+                    VoidGameMode->RemoveTelegraphedAttack(this);
+                }
+            }
+            else
+            {
+                if (MapCell && MapCell->GetOwningMap())
+                {
+                    MapCell->GetOwningMap()->RemoveEntityInfluence(this);
+                }
+                Death();
+            }
+            if (Queue)
+            {
+                Queue->PushDeath(this);
+            }
+            else
+            {
+                OnDeath.Broadcast(this);
+            }
+        }
+    }
+}
+
+bool AMapEntity::IsPresentationDeferred() const
+{
+    UWorld* World = GetWorld();
+    auto VoidGameMode = World ? Cast<AVoidGameMode>(World->GetAuthGameMode()) : nullptr;
+    return VoidGameMode && VoidGameMode->UsePresentationTimeline;
+}
+
+void AMapEntity::BroadcastGameplayEvent(const FGameplayEvent& Event, const FMapAttackInfo* Attack)
+{
+    switch (Event.Type)
+    {
+    case EGameplayEventType::Move:
+        OnMove.Broadcast(this, Event.FromCell, Event.ToCell);
+        break;
+    case EGameplayEventType::Attack:
+        for (int i = 0; Attack && i < Event.NumHits; i++)
+        {
+            OnAttack.Broadcast(this, *Attack);
         }
+        break;
+    case EGameplayEventType::HealthChanged:
+        OnHealthChanged.Broadcast(this);
+        break;
+    case EGameplayEventType::Death:
+        OnDeath.Broadcast(this);
+        break;
+    default:
+        break;
+    }
+}
+
+void AMapEntity::SetMaxHealth(int NewMaxHealth)
+{
+    MaxHealth = FMath::Max(NewMaxHealth, 1);
+    if (Health > MaxHealth)
+    {
+        SetHealth(MaxHealth);
     }
 }
 
@@ -5,9 +5,11 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "Util.h"
+#include "TurnArena.h"
 #include "MapEntity.generated.h"
 
 class AHexCell;
+struct FGameplayEvent;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMapEntityDelegate, class AMapEntity*, MapEntity);
 
@@ -39,9 +41,47 @@ public:
     UFUNCTION(BlueprintCallable)
     AHexCell* GetMapCell() const { return MapCell; }
 
+    UFUNCTION(BlueprintCallable)
+    int GetMoveDistance() const { return MoveDistance; }
+
+    UFUNCTION(BlueprintCallable)
+    int GetAttackDistance() const { return AttackDistance; }
+
     UFUNCTION(BlueprintCallable)
     bool MoveToMapCell(AHexCell* Cell);
 
+    //Puts the entity straight onto Cell with the given health, without tweens or gameplay events. Used by snapshot restores
+    void RestoreState(AHexCell* Cell, int NewHealth, int NewMaxHealth, bool HasAttackPending);
+
+    //Frees the current cell, if it's still ours, and drops our influence
+    void LeaveMapCell();
+
+    //Presentation timeline side of a move, slides from FromLocation to ToCell or snaps there when Animate is false
+    void PresentMove(const FVector& FromLocation, AHexCell* ToCell, bool Animate);
+
+    float GetMoveTweenDuration() const { return MoveTweenDuration; }
+
+    float GetAttackPresentDuration() const { return AttackPresentDuration; }
+
+    float GetDeathPresentDuration() const { return DeathPresentDuration; }
+
+    //Presentation timeline side of a health change or death, runs the native events the simulation held back
+    void PresentHealthChanged() { HealthChanged(); }
+    void PresentDeath() { Death(); }
+
+    //True while the presentation timeline plays the simulation's visuals, rather than them happening in place
+    bool IsPresentationDeferred() const;
+
+protected:
+
+    //Slides to ToCell, or the current cell when null
+    void TweenFrom(const FVector& FromLocation, AHexCell* ToCell = nullptr);
+
+    //Attaches to MapCell, or just moves there with a flat hierarchy
+    void SnapToMapCell();
+
+public:
+
     UFUNCTION(BlueprintCallable)
     bool PerformAttack(const FMapAttackInfo& AttackInfo);
 
@@ -51,9 +91,19 @@ public:
     UFUNCTION(BlueprintCallable)
     TArray<FHexMapCoord> GetMoveLocations() const;
 
+    //Same as GetMoveLocations but the result lives in the turn arena
+    void GatherMoveLocations(TTurnArray<FHexMapCoord>& OutLocations) const;
+
+    //For membership tests against the move range, the set keeps whichever bounds it was built with
+    void GatherMoveLocations(class FHexCoordSet& OutLocations) const;
+
     UFUNCTION(BlueprintCallable)
     TArray<FMapAttackInfo> GetAttacks() const;
 
+    //Direction indexes GetDirectionsAt, returns false if the attack has no locations
+    UFUNCTION(BlueprintCallable)
+    bool GetAttackInDirection(int Direction, FMapAttackInfo& OutAttackInfo) const;
+
 public:
 
     UFUNCTION(BlueprintCallable)
@@ -70,11 +120,9 @@ public:
 
 protected:
 
+    //The attack itself is held by the game mode, see AVoidGameMode::AddTelegraphedAttack
     bool AIHasAttackPending = false;
 
-    UPROPERTY(Transient)
-    FMapAttackInfo PendingAttackInfo;
-
 protected:
 
     UPROPERTY(EditDefaultsOnly)
@@ -89,6 +137,22 @@ protected:
     UPROPERTY(EditDefaultsOnly)
     int AttackDistance;
 
+    //Seconds to slide between cells, snaps when 0 or when there's no animation scheduler
+    UPROPERTY(EditDefaultsOnly, Category = Animation)
+    float MoveTweenDuration;
+
+    //Actor tick stays off except while a tween is running, for blueprints that only animate in Tick
+    UPROPERTY(EditDefaultsOnly, Category = Animation)
+    bool TickOnlyWhileAnimating;
+
+    //Seconds the presentation timeline gives the blueprint's attack animation before anything waiting on it plays
+    UPROPERTY(EditDefaultsOnly, Category = Animation)
+    float AttackPresentDuration;
+
+    //Seconds the presentation timeline holds this entity's slot for its death animation
+    UPROPERTY(EditDefaultsOnly, Category = Animation)
+    float DeathPresentDuration;
+
     UPROPERTY(BlueprintAssignable)
     FMapEntityMoveDelegate OnMove;
 
@@ -114,6 +178,12 @@ public:
     UFUNCTION(BlueprintCallable)
     void SetHealth(int NewHealth);
 
+    UFUNCTION(BlueprintCallable)
+    void SetMaxHealth(int NewMaxHealth);
+
+    //Blueprint side of a queued event, called as the event queue dispatches or as the presentation timeline plays it
+    void BroadcastGameplayEvent(const FGameplayEvent& Event, const FMapAttackInfo* Attack);
+
 protected:
 
     UFUNCTION(BlueprintNativeEvent)
@@ -0,0 +1,143 @@
+#include "PresentationTimeline.h"
+#include "MapEntity.h"
+#include "HexCell.h"
+
+void FPresentationTimeline::Record(TArrayView<const FGameplayEvent> Events, const FGameplayEventQueue& Queue)
+{
+    for (const auto& Event : Events)
+    {
+        AMapEntity* Entity = Event.Entity;
+        if (!Entity)
+        {
+            continue;
+        }
+
+        float Duration = 0.0f;
+        float StartTime = FMath::Max(PlaybackTime, BarrierTime);
+        if (const float* EntityEndTime = EntityEndTimes.Find(Entity))
+        {
+            StartTime = FMath::Max(StartTime, *EntityEndTime);
+        }
+
+        FCommand Command;
+        Command.Event = Event;
+        Command.Attack = INDEX_NONE;
+
+        switch (Event.Type)
+        {
+        case EGameplayEventType::Move:
+            Duration = Entity->GetMoveTweenDuration();
+            break;
+        case EGameplayEventType::Attack:
+            Duration = Entity->GetAttackPresentDuration();
+            Command.Attack = Attacks.Add(Queue.GetAttack(Event));
+            ImpactTime = FMath::Max(ImpactTime, StartTime + Duration);
+            break;
+        case EGameplayEventType::HealthChanged:
+            StartTime = FMath::Max(StartTime, ImpactTime);
+            break;
+        case EGameplayEventType::Death:
+            StartTime = FMath::Max(StartTime, ImpactTime);
+            Duration = Entity->GetDeathPresentDuration();
+            break;
+        }
+
+        Command.StartTime = StartTime;
+        EntityEndTimes.Add(Entity, StartTime + Duration);
+        EndTime = FMath::Max(EndTime, StartTime + Duration);
+
+        //Insert after anything starting at the same time so recording order breaks ties
+        int Index = Commands.Num();
+        while (Index > NextCommand && Commands[Index - 1].StartTime > StartTime)
+        {
+            Index--;
+        }
+        Commands.Insert(Command, Index);
+    }
+}
+
+void FPresentationTimeline::AddBarrier()
+{
+    BarrierTime = EndTime;
+}
+
+void FPresentationTimeline::Advance(float DeltaTime)
+{
+    PlaybackTime += DeltaTime;
+
+    //Started commands can record more through the delegates they broadcast, so index rather than iterate
+    while (NextCommand < Commands.Num() && Commands[NextCommand].StartTime <= PlaybackTime)
+    {
+        const FCommand Command = Commands[NextCommand++];
+        Start(Command, true);
+    }
+
+    if (!IsPlaying())
+    {
+        Reset();
+    }
+}
+
+void FPresentationTimeline::SkipToEnd()
+{
+    while (NextCommand < Commands.Num())
+    {
+        const FCommand Command = Commands[NextCommand++];
+        Start(Command, false);
+    }
+    Reset();
+}
+
+void FPresentationTimeline::Reset()
+{
+    Commands.Reset();
+    NextCommand = 0;
+    Attacks.Reset();
+    EntityEndTimes.Reset();
+    PlaybackTime = 0.0f;
+    EndTime = 0.0f;
+    BarrierTime = 0.0f;
+    ImpactTime = 0.0f;
+}
+
+void FPresentationTimeline::AddReferencedObjects(FReferenceCollector& Collector)
+{
+    //Started commands are done with, only the ones still to play need their objects
+    for (int i = NextCommand; i < Commands.Num(); i++)
+    {
+        Commands[i].Event.AddReferencedObjects(Collector);
+    }
+    for (auto& Attack : Attacks)
+    {
+        FGameplayEventQueue::AddAttackReferences(Collector, Attack);
+    }
+}
+
+void FPresentationTimeline::Start(const FCommand& Command, bool Animate)
+{
+    AMapEntity* Entity = Command.Event.Entity;
+    if (!Entity)
+    {
+        return;
+    }
+
+    if (Command.Event.Type == EGameplayEventType::Move)
+    {
+        AHexCell* FromCell = Command.Event.FromCell;
+        AHexCell* ToCell = Command.Event.ToCell;
+        if (ToCell)
+        {
+            Entity->PresentMove(FromCell ? FromCell->GetActorLocation() : Entity->GetActorLocation(), ToCell, Animate);
+        }
+    }
+    else if (Command.Event.Type == EGameplayEventType::HealthChanged)
+    {
+        Entity->PresentHealthChanged();
+    }
+    else if (Command.Event.Type == EGameplayEventType::Death)
+    {
+        Entity->PresentDeath();
+    }
+
+    Entity->BroadcastGameplayEvent(Command.Event, Command.Attack != INDEX_NONE ? &Attacks[Command.Attack] : nullptr);
+}
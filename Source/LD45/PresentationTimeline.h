@@ -0,0 +1,70 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/GCObject.h"
+#include "Util.h"
+#include "GameplayEventQueue.h"
+
+/**
+ * Visual playback of an already simulated turn. Gameplay events are recorded as timestamped commands,
+ * one entity's commands play back to back while different entities overlap.
+ * Starting a command runs its tween and broadcasts the entity's blueprint delegates, so blueprint
+ * animation follows playback instead of the simulation.
+ * Recorded commands keep their entities, cells and attack payloads alive until they have played.
+ * Owned by AVoidGameMode, only fed while UsePresentationTimeline is set.
+ */
+class LD45_API FPresentationTimeline : public FGCObject
+{
+public:
+
+    void Record(TArrayView<const FGameplayEvent> Events, const FGameplayEventQueue& Queue);
+
+    //Nothing recorded after this starts before everything recorded so far has finished
+    void AddBarrier();
+
+    //Starts every command whose time has come
+    void Advance(float DeltaTime);
+
+    //Fast forward, starts everything left in order without animating
+    void SkipToEnd();
+
+    void Reset();
+
+    bool IsPlaying() const { return NextCommand < Commands.Num() || PlaybackTime < EndTime; }
+
+    //Seconds of playback left at a play rate of 1
+    float GetTimeRemaining() const { return FMath::Max(0.0f, EndTime - PlaybackTime); }
+
+    int Num() const { return Commands.Num() - NextCommand; }
+
+    //FGCObject
+    virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+    virtual FString GetReferencerName() const override { return TEXT("FPresentationTimeline"); }
+
+private:
+
+    struct FCommand
+    {
+        FGameplayEvent Event;
+        int Attack;
+        float StartTime;
+    };
+
+    void Start(const FCommand& Command, bool Animate);
+
+    //Sorted by StartTime, everything before NextCommand has been started
+    TArray<FCommand> Commands;
+    int NextCommand = 0;
+
+    TArray<FMapAttackInfo> Attacks;
+
+    //When each entity's last command finishes
+    TMap<TWeakObjectPtr<AMapEntity>, float> EntityEndTimes;
+
+    float PlaybackTime = 0.0f;
+    float EndTime = 0.0f;
+    float BarrierTime = 0.0f;
+
+    //Damage shows once the attack that dealt it has played
+    float ImpactTime = 0.0f;
+};
@@ -0,0 +1,76 @@
+#include "Misc/AutomationTest.h"
+#include "LD45TestWorld.h"
+#include "VoidGameMode.h"
+#include "HexMap.h"
+#include "GameStateSnapshot.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGameStateSnapshotRoundTripTest, "LD45.Snapshot.RoundTrip", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGameStateSnapshotRoundTripTest::RunTest(const FString& Parameters)
+{
+    FGameStateSnapshot Snapshot;
+    Snapshot.MapId = TEXT("/Game/Maps/Test");
+    Snapshot.FlowState = (uint8)EGameFlowStateType::PlayerPlayCards;
+    Snapshot.RandomSeed = 1234;
+    Snapshot.AddObject(AHexMap::StaticClass());
+    Snapshot.Entities.AddZeroed(2);
+    Snapshot.Entities[1].Coord = FHexMapCoord(3, 4);
+    Snapshot.Entities[1].Health = 2;
+    Snapshot.AttackLocations.Emplace(5, 6);
+    Snapshot.Attacks.Add({ 1, 0, 1 });
+
+    TArray<uint8> Bytes;
+    Snapshot.Write(Bytes);
+
+    FGameStateSnapshot Loaded;
+    TestTrue(TEXT("Reads back"), Loaded.Read(Bytes));
+    TestEqual(TEXT("Map id"), Loaded.MapId, Snapshot.MapId);
+    TestEqual(TEXT("Flow state"), Loaded.FlowState, Snapshot.FlowState);
+    TestEqual(TEXT("Seed"), Loaded.RandomSeed, Snapshot.RandomSeed);
+    TestEqual(TEXT("Entities"), Loaded.Entities.Num(), 2);
+    TestTrue(TEXT("Entity coord"), Loaded.Entities[1].Coord == FHexMapCoord(3, 4));
+    TestEqual(TEXT("Entity health"), (int)Loaded.Entities[1].Health, 2);
+    TestEqual(TEXT("Attack slice"), Loaded.Attacks[0].NumLocations, 1);
+    TestTrue(TEXT("Class resolves"), Loaded.ResolveObject<UClass>(0) == AHexMap::StaticClass());
+
+    //Truncated data must fail cleanly rather than read past the end
+    Bytes.SetNum(Bytes.Num() / 2);
+    TestFalse(TEXT("Truncated buffer is rejected"), Loaded.Read(Bytes));
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGameStateSnapshotReenterTest, "LD45.Snapshot.ReenterFlowState", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGameStateSnapshotReenterTest::RunTest(const FString& Parameters)
+{
+    FLD45TestWorld TestWorld;
+    AVoidGameMode* GameMode = TestWorld.Spawn<AVoidGameMode>();
+    AHexMap* Map = TestWorld.Spawn<AHexMap>();
+    if (!TestNotNull(TEXT("Game mode"), GameMode) || !TestNotNull(TEXT("Map"), Map)
+        || !TestTrue(TEXT("Map assigned"), FLD45TestWorld::SetObjectProperty(GameMode, TEXT("HexMapActor"), Map)))
+    {
+        return false;
+    }
+    GameMode->UndoDepth = 4;
+
+    FGameStateSnapshot Snapshot;
+    GameMode->CaptureSnapshot(Snapshot);
+    Snapshot.FlowState = (uint8)EGameFlowStateType::GameStart;
+
+    //Entering GameStart clears undo history, so a non-empty history going to 0 shows the state was entered
+    for (int Pass = 0; Pass < 2; Pass++)
+    {
+        GameMode->PushUndoSnapshot();
+        TestEqual(TEXT("Undo snapshot pushed"), GameMode->GetNumUndoSnapshots(), 1);
+
+        //The second pass restores into the state the game mode is already in, which is what a load or undo usually does
+        TestTrue(TEXT("Restores"), GameMode->RestoreSnapshot(Snapshot, true));
+        TestTrue(TEXT("In the saved state"), GameMode->GetCurrentFlowState() == EGameFlowStateType::GameStart);
+        TestEqual(*FString::Printf(TEXT("Saved state entered on pass %d"), Pass), GameMode->GetNumUndoSnapshots(), 0);
+    }
+    return true;
+}
+
+#endif
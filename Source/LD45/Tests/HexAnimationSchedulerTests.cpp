@@ -0,0 +1,32 @@
+#include "Misc/AutomationTest.h"
+#include "UObject/Package.h"
+#include "HexAnimationScheduler.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHexAnimationSchedulerActiveTest, "LD45.AnimationScheduler.IsActive", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHexAnimationSchedulerActiveTest::RunTest(const FString& Parameters)
+{
+    UHexAnimationScheduler* Scheduler = NewObject<UHexAnimationScheduler>();
+    UObject* Owner = GetTransientPackage();
+
+    int Updates = 0;
+    const int Finishing = Scheduler->Play(Owner, [&Updates](float DeltaTime) { return ++Updates < 2; });
+    const int Cancelled = Scheduler->Play(Owner, [](float DeltaTime) { return true; });
+    TestTrue(TEXT("Playing work is active"), Scheduler->IsActive(Finishing) && Scheduler->IsActive(Cancelled));
+
+    //Owners like AHexMap poll this, work dropped by a cancel must read as over
+    Scheduler->Cancel(Cancelled);
+    TestFalse(TEXT("Cancelled work isn't active"), Scheduler->IsActive(Cancelled));
+
+    Scheduler->Tick(0.1f);
+    TestTrue(TEXT("Still running after one update"), Scheduler->IsActive(Finishing));
+    Scheduler->Tick(0.1f);
+    TestFalse(TEXT("Finished work isn't active"), Scheduler->IsActive(Finishing));
+    TestEqual(TEXT("Everything removed"), Scheduler->GetNumAnimations(), 0);
+    TestFalse(TEXT("Unknown ids aren't active"), Scheduler->IsActive(INDEX_NONE));
+    return true;
+}
+
+#endif
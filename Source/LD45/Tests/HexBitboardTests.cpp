@@ -0,0 +1,137 @@
+#include "Misc/AutomationTest.h"
+#include "HexBitboard.h"
+#include "HexMath.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+    //Wider than a word so shifts carry between words
+    const int TestWidth = 70;
+    const int TestHeight = 9;
+
+    struct FTestBoard
+    {
+        FTestBoard(int32 Seed)
+        {
+            FRandomStream Random(Seed);
+            for (auto* Board : { &Exists, &Traversable, &Occupied, &Sources })
+            {
+                Board->Init(TestWidth, TestHeight);
+            }
+
+            for (int y = 0; y < TestHeight; y++)
+            {
+                for (int x = 0; x < TestWidth; x++)
+                {
+                    const FHexMapCoord Coord(x, y);
+                    const float Roll = Random.FRand();
+                    const bool IsHole = Roll < 0.1f;
+                    const bool IsWall = !IsHole && Roll < 0.2f;
+                    Exists.Set(Coord, !IsHole);
+                    Traversable.Set(Coord, !IsHole && !IsWall);
+                    if (!IsHole && !IsWall && Random.FRand() < 0.15f)
+                    {
+                        Occupied.Set(Coord);
+                        Sources.Set(Coord, Random.FRand() < 0.5f);
+                    }
+                }
+            }
+        }
+
+        FHexBitboard Exists;
+        FHexBitboard Traversable;
+        FHexBitboard Occupied;
+        FHexBitboard Sources;
+    };
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHexBitboardAttackMaskTest, "LD45.HexBitboard.AttackMask", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHexBitboardAttackMaskTest::RunTest(const FString& Parameters)
+{
+    for (int32 Seed = 0; Seed < 4; Seed++)
+    {
+        const FTestBoard Board(Seed);
+        const int Distance = 1 + Seed * 2;
+
+        FHexBitboard Mask;
+        HexBitboardQueries::AttackMask(Board.Sources, Distance, Board.Exists, Board.Traversable, Board.Occupied, Mask);
+
+        //One ray at a time, the way AMapEntity::GetAttacks walks them
+        FHexBitboard Expected;
+        Expected.Init(TestWidth, TestHeight);
+        TArray<FHexMapCoord> Sources;
+        Board.Sources.GetCoords(Sources);
+        for (const auto& Source : Sources)
+        {
+            for (int Direction = 0; Direction < 6; Direction++)
+            {
+                FHexMapCoord Coord = Source;
+                for (int Step = 0; Step < Distance; Step++)
+                {
+                    Coord += GetDirectionsAt(Coord)[Direction];
+                    if (!Coord.IsValid(TestWidth, TestHeight) || (Board.Exists.Get(Coord) && !Board.Traversable.Get(Coord)))
+                    {
+                        break;
+                    }
+                    if (!Board.Exists.Get(Coord))
+                    {
+                        continue;
+                    }
+                    Expected.Set(Coord);
+                    if (Board.Occupied.Get(Coord))
+                    {
+                        break;
+                    }
+                }
+            }
+        }
+
+        for (int y = 0; y < TestHeight; y++)
+        {
+            for (int x = 0; x < TestWidth; x++)
+            {
+                if (Mask.Get({ x, y }) != Expected.Get({ x, y }))
+                {
+                    AddError(FString::Printf(TEXT("Seed %d: (%d, %d) is %s the mask"), Seed, x, y, Mask.Get({ x, y }) ? TEXT("wrongly in") : TEXT("missing from")));
+                }
+            }
+        }
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHexBitboardZoneOfControlTest, "LD45.HexBitboard.ZoneOfControl", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHexBitboardZoneOfControlTest::RunTest(const FString& Parameters)
+{
+    const FTestBoard Board(7);
+    TArray<FHexMapCoord> Sources;
+    Board.Sources.GetCoords(Sources);
+
+    for (int Radius = 0; Radius <= 3; Radius++)
+    {
+        FHexBitboard Zone;
+        HexBitboardQueries::ZoneOfControl(Board.Sources, Radius, Zone);
+
+        for (int y = 0; y < TestHeight; y++)
+        {
+            for (int x = 0; x < TestWidth; x++)
+            {
+                bool IsInRange = false;
+                for (const auto& Source : Sources)
+                {
+                    IsInRange |= HexMath::Distance(Source, FHexMapCoord(x, y)) <= Radius;
+                }
+                if (Zone.Get({ x, y }) != IsInRange)
+                {
+                    AddError(FString::Printf(TEXT("Radius %d: (%d, %d) is %s the zone"), Radius, x, y, IsInRange ? TEXT("missing from") : TEXT("wrongly in")));
+                }
+            }
+        }
+    }
+    return true;
+}
+
+#endif
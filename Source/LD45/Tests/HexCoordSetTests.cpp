@@ -0,0 +1,58 @@
+#include "Misc/AutomationTest.h"
+#include "HexCoordSet.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+    void CheckSet(FAutomationTestBase& Test, FHexCoordSet& Set, const TCHAR* What)
+    {
+        FRandomStream Random(45);
+        TArray<FHexMapCoord> Added;
+        for (int i = 0; i < 200; i++)
+        {
+            const FHexMapCoord Coord(Random.RandHelper(20), Random.RandHelper(20));
+            const bool IsNew = !Added.Contains(Coord);
+            Test.TestEqual(*FString::Printf(TEXT("%s: Add reports new coords"), What), Set.Add(Coord), IsNew);
+            if (IsNew)
+            {
+                Added.Add(Coord);
+            }
+        }
+
+        Test.TestEqual(*FString::Printf(TEXT("%s: Num"), What), Set.Num(), Added.Num());
+        for (int y = 0; y < 20; y++)
+        {
+            for (int x = 0; x < 20; x++)
+            {
+                const FHexMapCoord Coord(x, y);
+                Test.TestEqual(*FString::Printf(TEXT("%s: Contains"), What), Set.Contains(Coord), Added.Contains(Coord));
+                Test.TestEqual(*FString::Printf(TEXT("%s: Find is the insertion index"), What), Set.Find(Coord), Added.IndexOfByKey(Coord));
+            }
+        }
+
+        Set.Reset();
+        Test.TestEqual(*FString::Printf(TEXT("%s: Reset empties"), What), Set.Num(), 0);
+        Test.TestFalse(*FString::Printf(TEXT("%s: Reset clears membership"), What), Set.Contains(Added[0]));
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHexCoordSetTest, "LD45.HexCoordSet.Membership", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHexCoordSetTest::RunTest(const FString& Parameters)
+{
+    FHexCoordSet Bounded(20, 20);
+    CheckSet(*this, Bounded, TEXT("Bounded"));
+    TestFalse(TEXT("Bounded rejects coords off the map"), Bounded.Add(FHexMapCoord(-1, 3)));
+
+    FHexCoordSet Hashed;
+    CheckSet(*this, Hashed, TEXT("Hashed"));
+
+    //Negative coords pack to the top of the key range, including the all ones key
+    TestTrue(TEXT("Hashed takes (-1, -1)"), Hashed.Add(FHexMapCoord(-1, -1)));
+    TestFalse(TEXT("Hashed rejects (-1, -1) twice"), Hashed.Add(FHexMapCoord(-1, -1)));
+    TestEqual(TEXT("Hashed finds (-1, -1)"), Hashed.Find(FHexMapCoord(-1, -1)), 0);
+    return true;
+}
+
+#endif
@@ -0,0 +1,61 @@
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "HexMapData.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+    UHexMapData* MakeMapData(int Width, int Height)
+    {
+        UHexMapData* MapData = NewObject<UHexMapData>();
+        MapData->Width = Width;
+        MapData->Height = Height;
+        MapData->CellTypeNames = { TEXT("Grass"), TEXT("Water") };
+        MapData->CellTypes.Init(1, Width * Height);
+        MapData->CellTypes[0] = 0;
+        MapData->CellTypes[1] = 2;
+        MapData->CellPositions.SetNumZeroed(Width * Height);
+        MapData->PlayerSpawnLocations.Emplace(Width - 1, Height - 1);
+        return MapData;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHexMapDataValidationTest, "LD45.HexMapData.Validation", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHexMapDataValidationTest::RunTest(const FString& Parameters)
+{
+    TestTrue(TEXT("Consistent data is valid"), MakeMapData(4, 3)->IsValid());
+
+    UHexMapData* MapData = MakeMapData(4, 3);
+    MapData->CellTypes[5] = 3;
+    TestFalse(TEXT("Type past the palette"), MapData->IsValid());
+
+    MapData = MakeMapData(4, 3);
+    MapData->CellPositions.Pop();
+    TestFalse(TEXT("Missing cell positions"), MapData->IsValid());
+
+    MapData = MakeMapData(4, 3);
+    MapData->CellTypes.Pop();
+    TestFalse(TEXT("Missing cell types"), MapData->IsValid());
+
+    MapData = MakeMapData(4, 3);
+    MapData->EnemySpawnLocations.Emplace(4, 0);
+    TestFalse(TEXT("Spawn off the board"), MapData->IsValid());
+
+    //A loose file that reads cleanly but points outside its palette is refused rather than loaded
+    MapData = MakeMapData(4, 3);
+    MapData->CellTypes[5] = 200;
+    const FString Filename = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("HexMapDataValidation.hexmap"));
+    if (TestTrue(TEXT("Saves"), MapData->SaveToFile(Filename)))
+    {
+        AddExpectedError(TEXT("Failed to load map data"), EAutomationExpectedErrorFlags::Contains, 2);
+        TestNull(TEXT("Mapped load is refused"), UHexMapData::LoadFromFile(Filename, true));
+        TestNull(TEXT("Buffered load is refused"), UHexMapData::LoadFromFile(Filename, false));
+        IFileManager::Get().Delete(*Filename);
+    }
+    return true;
+}
+
+#endif
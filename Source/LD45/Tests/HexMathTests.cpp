@@ -0,0 +1,167 @@
+#include "Misc/AutomationTest.h"
+#include "HexMath.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+    //Board coords only, GetDirectionsAt reads odd rows with y % 2
+    const int TestBoardSize = 10;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHexMathRoundTripTest, "LD45.HexMath.RoundTrip", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHexMathRoundTripTest::RunTest(const FString& Parameters)
+{
+    for (int y = -TestBoardSize; y < TestBoardSize; y++)
+    {
+        for (int x = -TestBoardSize; x < TestBoardSize; x++)
+        {
+            const FHexMapCoord Coord(x, y);
+            if (HexMath::AxialToOffset(HexMath::OffsetToAxial(Coord)) != Coord)
+            {
+                AddError(FString::Printf(TEXT("Offset (%d, %d) doesn't survive a round trip through axial"), x, y));
+            }
+
+            const FHexAxial Axial(x, y);
+            if (HexMath::OffsetToAxial(HexMath::AxialToOffset(Axial)) != Axial)
+            {
+                AddError(FString::Printf(TEXT("Axial (%d, %d) doesn't survive a round trip through offset"), x, y));
+            }
+        }
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHexMathNeighbourOrderTest, "LD45.HexMath.NeighbourOrder", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHexMathNeighbourOrderTest::RunTest(const FString& Parameters)
+{
+    for (int y = 0; y < TestBoardSize; y++)
+    {
+        for (int x = 0; x < TestBoardSize; x++)
+        {
+            const FHexMapCoord Coord(x, y);
+            const FHexAxial Axial = HexMath::OffsetToAxial(Coord);
+            const auto& Directions = GetDirectionsAt(Coord);
+            for (int i = 0; i < 6; i++)
+            {
+                const FHexAxial Neighbour = HexMath::Neighbor(Axial, i);
+                if (HexMath::AxialToOffset(Neighbour) != Coord + Directions[i])
+                {
+                    AddError(FString::Printf(TEXT("Direction %d from (%d, %d) disagrees with GetDirectionsAt"), i, x, y));
+                }
+                if (HexMath::Distance(Axial, Neighbour) != 1)
+                {
+                    AddError(FString::Printf(TEXT("Direction %d from (%d, %d) isn't adjacent"), i, x, y));
+                }
+            }
+        }
+    }
+
+    TestTrue(TEXT("Directions wrap"), HexMath::Direction(-1) == HexMath::Direction(5) && HexMath::Direction(6) == HexMath::Direction(0));
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHexMathRingSpiralTest, "LD45.HexMath.RingSpiral", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHexMathRingSpiralTest::RunTest(const FString& Parameters)
+{
+    const FHexAxial Center = HexMath::OffsetToAxial(3, 5);
+    for (int Radius = 0; Radius <= 6; Radius++)
+    {
+        TSet<uint32> Seen;
+        int Count = 0;
+        for (FHexRingIterator It(Center, Radius); It; ++It)
+        {
+            TestEqual(TEXT("Ring cell distance"), HexMath::Distance(Center, *It), Radius);
+            Seen.Add(HexMath::AxialToOffset(*It).Pack());
+            Count++;
+        }
+        TestEqual(*FString::Printf(TEXT("Ring %d count"), Radius), Count, Radius == 0 ? 1 : 6 * Radius);
+        TestEqual(*FString::Printf(TEXT("Ring %d is unique"), Radius), Seen.Num(), Count);
+
+        Seen.Reset();
+        Count = 0;
+        int LastRadius = 0;
+        for (FHexSpiralIterator It(Center, Radius); It; ++It)
+        {
+            TestEqual(TEXT("Spiral radius"), It.GetRadius(), HexMath::Distance(Center, *It));
+            TestTrue(TEXT("Spiral walks outwards"), It.GetRadius() >= LastRadius);
+            LastRadius = It.GetRadius();
+            Seen.Add(HexMath::AxialToOffset(*It).Pack());
+            Count++;
+        }
+        TestEqual(*FString::Printf(TEXT("Spiral %d count"), Radius), Count, HexMath::SpiralCount(Radius));
+        TestEqual(*FString::Printf(TEXT("Spiral %d is unique"), Radius), Seen.Num(), Count);
+    }
+
+    TestFalse(TEXT("Negative ring is empty"), (bool)FHexRingIterator(Center, -1));
+    TestFalse(TEXT("Negative spiral is empty"), (bool)FHexSpiralIterator(Center, -1));
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHexMathRotationTest, "LD45.HexMath.Rotation", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHexMathRotationTest::RunTest(const FString& Parameters)
+{
+    for (int i = 0; i < 6; i++)
+    {
+        TestTrue(*FString::Printf(TEXT("Direction %d turns clockwise into the next"), i), HexMath::RotateCW(HexMath::Direction(i)) == HexMath::Direction(i + 1));
+        TestTrue(*FString::Printf(TEXT("Direction %d turns anticlockwise into the last"), i), HexMath::RotateCCW(HexMath::Direction(i)) == HexMath::Direction(i - 1));
+    }
+
+    const FHexAxial Axial(3, -1);
+    const FHexAxial Center(-2, 4);
+    for (int Steps = -7; Steps <= 7; Steps++)
+    {
+        const FHexAxial Rotated = HexMath::Rotate(Axial, Steps);
+        TestEqual(TEXT("Rotation keeps length"), HexMath::Length(Rotated), HexMath::Length(Axial));
+        TestTrue(TEXT("Rotation undoes"), HexMath::Rotate(Rotated, -Steps) == Axial);
+        TestTrue(TEXT("Six steps are a full turn"), HexMath::Rotate(Axial, Steps + 6) == Rotated);
+
+        const FHexAxial Around = HexMath::RotateAround(Axial, Center, Steps);
+        TestEqual(TEXT("Rotation around a center keeps distance"), HexMath::Distance(Around, Center), HexMath::Distance(Axial, Center));
+    }
+    TestTrue(TEXT("Negative steps turn anticlockwise"), HexMath::Rotate(Axial, -1) == HexMath::RotateCCW(Axial));
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHexMathLineTest, "LD45.HexMath.Line", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHexMathLineTest::RunTest(const FString& Parameters)
+{
+    const FHexAxial Start = HexMath::OffsetToAxial(4, 4);
+    for (FHexSpiralIterator End(Start, 5); End; ++End)
+    {
+        int Count = 0;
+        FHexAxial Last = Start;
+        for (FHexLineIterator It(Start, *End); It; ++It)
+        {
+            TestEqual(TEXT("Line step"), It.GetStep(), Count);
+            TestEqual(TEXT("Line cell distance from start"), HexMath::Distance(Start, *It), Count);
+            if (Count > 0 && HexMath::Distance(Last, *It) != 1)
+            {
+                AddError(FString::Printf(TEXT("Line to (%d, %d) skips a cell at step %d"), (*End).Q, (*End).R, Count));
+            }
+            Last = *It;
+            Count++;
+        }
+        TestEqual(TEXT("Line count"), Count, HexMath::Distance(Start, *End) + 1);
+        TestTrue(TEXT("Line ends on End"), Last == *End);
+
+        //Ties must break the same way far from the origin, where a float nudge would be lost
+        const FHexAxial Far(30000, -20000);
+        FHexLineIterator Near(Start, *End);
+        for (FHexLineIterator It(Start + Far, *End + Far); It; ++It, ++Near)
+        {
+            if (!(*It == *Near + Far))
+            {
+                AddError(FString::Printf(TEXT("Far line to (%d, %d) differs at step %d"), (*End).Q, (*End).R, It.GetStep()));
+            }
+        }
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,105 @@
+#include "Misc/AutomationTest.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Tests/AutomationCommon.h"
+#include "Engine/Engine.h"
+#include "LD45Benchmark.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+DEFINE_LOG_CATEGORY_STATIC(LogLD45BenchmarkTest, Log, All)
+
+namespace
+{
+    //Budgets live in DefaultGame.ini, one per series and map size:
+    //  [LD45.Bench]
+    //  +P90BudgetMs=(Series="GameLoop",MapSize=64,Ms=16.0)
+    const TCHAR* BenchmarkConfigSection = TEXT("LD45.Bench");
+
+    UWorld* FindGameWorld()
+    {
+        for (const FWorldContext& Context : GEngine->GetWorldContexts())
+        {
+            if ((Context.WorldType == EWorldType::Game || Context.WorldType == EWorldType::PIE) && Context.World())
+            {
+                return Context.World();
+            }
+        }
+        return nullptr;
+    }
+
+    void CheckBudgets(FAutomationTestBase& Test, const FLD45Benchmark& Benchmark)
+    {
+        TArray<FString> Budgets;
+        GConfig->GetArray(BenchmarkConfigSection, TEXT("P90BudgetMs"), Budgets, GGameIni);
+        if (Budgets.Num() == 0)
+        {
+            Test.AddWarning(TEXT("No P90BudgetMs entries in [LD45.Bench], nothing to check against"));
+        }
+
+        for (const FString& Budget : Budgets)
+        {
+            FString Series;
+            int MapSize = 0;
+            float BudgetMs = 0.0f;
+            if (!FParse::Value(*Budget, TEXT("Series="), Series) || !FParse::Value(*Budget, TEXT("MapSize="), MapSize) || !FParse::Value(*Budget, TEXT("Ms="), BudgetMs))
+            {
+                Test.AddError(FString::Printf(TEXT("Malformed budget %s"), *Budget));
+                continue;
+            }
+
+            double P90Ms = 0.0;
+            if (!Benchmark.GetPercentileMs(Series, MapSize, 0.9, P90Ms))
+            {
+                Test.AddWarning(FString::Printf(TEXT("%s at %d didn't run"), *Series, MapSize));
+            }
+            else if (P90Ms > BudgetMs)
+            {
+                Test.AddError(FString::Printf(TEXT("%s at %d: p90 %.3fms over its %.3fms budget"), *Series, MapSize, P90Ms, BudgetMs));
+            }
+            else
+            {
+                UE_LOG(LogLD45BenchmarkTest, Display, TEXT("[Bench] %s at %d: p90 %.3fms of %.3fms"), *Series, MapSize, P90Ms, BudgetMs);
+            }
+        }
+    }
+}
+
+DEFINE_LATENT_AUTOMATION_COMMAND_ONE_PARAMETER(FRunLD45BenchmarkCommand, FAutomationTestBase*, Test);
+
+bool FRunLD45BenchmarkCommand::Update()
+{
+    FLD45Benchmark Benchmark(FindGameWorld(), FLD45Benchmark::FSettings());
+    if (!Benchmark.Run())
+    {
+        Test->AddError(TEXT("Benchmark couldn't run, the map needs a VoidGameMode and a tile map"));
+        return true;
+    }
+
+    UE_LOG(LogLD45BenchmarkTest, Display, TEXT("[Bench] Report written to %s"), *Benchmark.SaveReport());
+    CheckBudgets(*Test, Benchmark);
+    return true;
+}
+
+/**
+ * LD45.Bench as an automation test, fails when a series' p90 goes over its budget in DefaultGame.ini.
+ *   UE4Editor LD45 -game -nullrhi -unattended -ExecCmds="Automation RunTests LD45.Bench" -TestExit="Automation Test Queue Empty"
+ */
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FLD45BenchmarkTest, "LD45.Bench", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+void FLD45BenchmarkTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+    OutBeautifiedNames.Add(TEXT("Level_01"));
+    OutTestCommands.Add(TEXT("/Game/Maps/Level_01"));
+}
+
+bool FLD45BenchmarkTest::RunTest(const FString& Parameters)
+{
+    AutomationOpenMap(Parameters);
+
+    //Gives the deck time to load so its series run too
+    ADD_LATENT_AUTOMATION_COMMAND(FWaitLatentCommand(2.0f));
+    ADD_LATENT_AUTOMATION_COMMAND(FRunLD45BenchmarkCommand(this));
+    return true;
+}
+
+#endif
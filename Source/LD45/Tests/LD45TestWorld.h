@@ -0,0 +1,45 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "UObject/UnrealType.h"
+
+/**
+ * Bare game world for automation tests that need actors but not a level or blueprints.
+ * Nothing has begun play, tests drive the actors directly.
+ */
+struct FLD45TestWorld
+{
+    FLD45TestWorld()
+    {
+        World = UWorld::CreateWorld(EWorldType::Game, false);
+        FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+        WorldContext.SetCurrentWorld(World);
+    }
+
+    ~FLD45TestWorld()
+    {
+        GEngine->DestroyWorldContext(World);
+        World->DestroyWorld(false);
+    }
+
+    template<typename T>
+    T* Spawn(UClass* Class = T::StaticClass())
+    {
+        return World->SpawnActor<T>(Class);
+    }
+
+    //Sets a UPROPERTY object reference the test can't reach directly, e.g. a protected BlueprintReadWrite one
+    static bool SetObjectProperty(UObject* Object, FName PropertyName, UObject* Value)
+    {
+        UObjectProperty* Property = FindField<UObjectProperty>(Object->GetClass(), PropertyName);
+        if (Property)
+        {
+            Property->SetObjectPropertyValue_InContainer(Object, Value);
+        }
+        return Property != nullptr;
+    }
+
+    UWorld* World;
+};
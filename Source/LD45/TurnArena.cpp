@@ -0,0 +1,145 @@
+#include "TurnArena.h"
+#include "LD45Stats.h"
+
+namespace
+{
+    const SIZE_T TurnArenaAlignment = 16;
+
+    FTurnArena* ActiveTurnArena = nullptr;
+}
+
+FTurnArena::FTurnArena(SIZE_T InBlockSize)
+    : BlockSize(InBlockSize)
+{
+}
+
+FTurnArena::~FTurnArena()
+{
+    ensureMsgf(LiveAllocations == 0, TEXT("Turn arena destroyed with %d live allocations"), LiveAllocations);
+    if (ActiveTurnArena == this)
+    {
+        ActiveTurnArena = nullptr;
+    }
+    for (const auto& Block : Blocks)
+    {
+        FMemory::Free(Block.Data);
+    }
+}
+
+void* FTurnArena::Allocate(SIZE_T Size)
+{
+    Size = Align(FMath::Max<SIZE_T>(Size, 1), TurnArenaAlignment);
+
+    //Move on to the next block that fits, anything bigger than a block gets one of its own
+    while (CurrentBlock < Blocks.Num() && Offset + Size > Blocks[CurrentBlock].Size)
+    {
+        CurrentBlock++;
+        Offset = 0;
+    }
+    if (CurrentBlock == Blocks.Num())
+    {
+        const SIZE_T NewBlockSize = FMath::Max(BlockSize, Size);
+        Blocks.Add({ (uint8*)FMemory::Malloc(NewBlockSize, TurnArenaAlignment), NewBlockSize });
+        Offset = 0;
+    }
+
+    void* Result = Blocks[CurrentBlock].Data + Offset;
+    Offset += Size;
+
+    LiveAllocations++;
+    NumAllocations++;
+    BytesAllocated += Size;
+
+    INC_DWORD_STAT(STAT_LD45_ArenaAllocations);
+    INC_DWORD_STAT_BY(STAT_LD45_ArenaBytes, Size);
+    return Result;
+}
+
+bool FTurnArena::Reset()
+{
+    if (!ensureMsgf(LiveAllocations == 0, TEXT("Turn arena reset with %d live allocations"), LiveAllocations))
+    {
+        return false;
+    }
+
+    //Fold a turn that overflowed into one block big enough for it next time
+    if (Blocks.Num() > 1)
+    {
+        const SIZE_T Capacity = GetCapacity();
+        for (const auto& Block : Blocks)
+        {
+            FMemory::Free(Block.Data);
+        }
+        Blocks.Reset();
+        BlockSize = FMath::Max(BlockSize, Capacity);
+    }
+
+    CurrentBlock = 0;
+    Offset = 0;
+    NumAllocations = 0;
+    BytesAllocated = 0;
+    return true;
+}
+
+SIZE_T FTurnArena::GetCapacity() const
+{
+    SIZE_T Capacity = 0;
+    for (const auto& Block : Blocks)
+    {
+        Capacity += Block.Size;
+    }
+    return Capacity;
+}
+
+FTurnArena* FTurnArena::GetActive()
+{
+    return IsInGameThread() ? ActiveTurnArena : nullptr;
+}
+
+void FTurnArena::SetActive(FTurnArena* Arena)
+{
+    check(IsInGameThread());
+    ActiveTurnArena = Arena;
+}
+
+void FTurnArenaAllocator::ForAnyElementType::ResizeAllocation(SizeType PreviousNumElements, SizeType NumElements, SIZE_T NumBytesPerElement)
+{
+    if (NumElements == 0)
+    {
+        Free();
+        return;
+    }
+
+    FTurnArena* Active = FTurnArena::GetActive();
+    if (!Active && !Arena)
+    {
+        Data = (FScriptContainerElement*)FMemory::Realloc(Data, NumElements * NumBytesPerElement);
+        return;
+    }
+
+    void* NewData = Active ? Active->Allocate(NumElements * NumBytesPerElement) : FMemory::Malloc(NumElements * NumBytesPerElement);
+    if (Data && PreviousNumElements > 0)
+    {
+        FMemory::Memcpy(NewData, Data, FMath::Min(PreviousNumElements, NumElements) * NumBytesPerElement);
+    }
+    Free();
+    Data = (FScriptContainerElement*)NewData;
+    Arena = Active;
+}
+
+void FTurnArenaAllocator::ForAnyElementType::Free()
+{
+    if (Data)
+    {
+        if (Arena)
+        {
+            Arena->Release();
+        }
+        else
+        {
+            FMemory::Free(Data);
+        }
+    }
+    Data = nullptr;
+    Arena = nullptr;
+}
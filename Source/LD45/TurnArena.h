@@ -0,0 +1,143 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Linear allocator for short lived game thread scratch, rewound once per turn instead of freeing.
+ * Only one arena is active at a time; without one, or off the game thread, allocations go to the heap.
+ */
+class LD45_API FTurnArena
+{
+public:
+
+    explicit FTurnArena(SIZE_T InBlockSize = 64 * 1024);
+    ~FTurnArena();
+
+    FTurnArena(const FTurnArena&) = delete;
+    FTurnArena& operator=(const FTurnArena&) = delete;
+
+    void* Allocate(SIZE_T Size);
+
+    //Called as arena backed containers let go of their memory, nothing is actually freed
+    void Release() { LiveAllocations--; }
+
+    //Rewinds to the first block, fails if anything allocated this turn is still alive
+    bool Reset();
+
+    int GetNumAllocations() const { return NumAllocations; }
+    SIZE_T GetBytesAllocated() const { return BytesAllocated; }
+    SIZE_T GetCapacity() const;
+
+    static FTurnArena* GetActive();
+    static void SetActive(FTurnArena* Arena);
+
+private:
+
+    struct FBlock
+    {
+        uint8* Data;
+        SIZE_T Size;
+    };
+
+    TArray<FBlock> Blocks;
+    int CurrentBlock = 0;
+    SIZE_T Offset = 0;
+    SIZE_T BlockSize;
+
+    int LiveAllocations = 0;
+    int NumAllocations = 0;
+    SIZE_T BytesAllocated = 0;
+};
+
+/**
+ * TArray allocator drawing from the active FTurnArena. Growing copies into a fresh chunk of the arena,
+ * the old chunk is reclaimed when the arena resets. Containers using it must not outlive the turn.
+ */
+class LD45_API FTurnArenaAllocator
+{
+public:
+
+    typedef int32 SizeType;
+
+    enum { NeedsElementType = false };
+    enum { RequireRangeCheck = true };
+
+    class LD45_API ForAnyElementType
+    {
+    public:
+
+        ForAnyElementType() : Data(nullptr), Arena(nullptr) {}
+
+        ~ForAnyElementType() { Free(); }
+
+        FORCEINLINE void MoveToEmpty(ForAnyElementType& Other)
+        {
+            checkSlow(this != &Other);
+            Free();
+            Data = Other.Data;
+            Arena = Other.Arena;
+            Other.Data = nullptr;
+            Other.Arena = nullptr;
+        }
+
+        FORCEINLINE FScriptContainerElement* GetAllocation() const { return Data; }
+
+        void ResizeAllocation(SizeType PreviousNumElements, SizeType NumElements, SIZE_T NumBytesPerElement);
+
+        FORCEINLINE SizeType CalculateSlackReserve(SizeType NumElements, SIZE_T NumBytesPerElement) const
+        {
+            return DefaultCalculateSlackReserve(NumElements, NumBytesPerElement, false);
+        }
+
+        //Shrinking can't give anything back to the arena
+        FORCEINLINE SizeType CalculateSlackShrink(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+        {
+            return Arena ? NumAllocatedElements : DefaultCalculateSlackShrink(NumElements, NumAllocatedElements, NumBytesPerElement, true);
+        }
+
+        FORCEINLINE SizeType CalculateSlackGrow(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+        {
+            return DefaultCalculateSlackGrow(NumElements, NumAllocatedElements, NumBytesPerElement, false);
+        }
+
+        FORCEINLINE SIZE_T GetAllocatedSize(SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+        {
+            return NumAllocatedElements * NumBytesPerElement;
+        }
+
+        FORCEINLINE bool HasAllocation() { return Data != nullptr; }
+
+    private:
+
+        ForAnyElementType(const ForAnyElementType&);
+        ForAnyElementType& operator=(const ForAnyElementType&);
+
+        void Free();
+
+        FScriptContainerElement* Data;
+        FTurnArena* Arena;
+    };
+
+    template<typename ElementType>
+    class ForElementType : public ForAnyElementType
+    {
+    public:
+
+        ForElementType() {}
+
+        FORCEINLINE ElementType* GetAllocation() const
+        {
+            return (ElementType*)ForAnyElementType::GetAllocation();
+        }
+    };
+};
+
+template <>
+struct TAllocatorTraits<FTurnArenaAllocator> : TAllocatorTraitsBase<FTurnArenaAllocator>
+{
+    enum { SupportsMove = true };
+    enum { IsZeroConstruct = true };
+};
+
+template <typename T>
+using TTurnArray = TArray<T, FTurnArenaAllocator>;
@@ -23,7 +23,7 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite)
     int y;
 
-    FORCEINLINE bool IsValid(int MapWidth, int MapHeight)
+    FORCEINLINE bool IsValid(int MapWidth, int MapHeight) const
     {
         return x >= 0 && x < MapWidth && y >= 0 && y < MapHeight;
     }
@@ -33,6 +33,39 @@ public:
         return this->x == rhs.x && this->y == rhs.y;
     }
 
+    FORCEINLINE bool operator != (const FHexMapCoord& rhs) const
+    {
+        return !(*this == rhs);
+    }
+
+    //16 bits per axis, coords are expected to be within +/-32767
+    FORCEINLINE uint32 Pack() const
+    {
+        checkSlow(FMath::Abs(x) <= MAX_int16 && FMath::Abs(y) <= MAX_int16);
+        return uint32(uint16(x)) | (uint32(uint16(y)) << 16);
+    }
+
+    static FORCEINLINE FHexMapCoord Unpack(uint32 Key)
+    {
+        return FHexMapCoord(int16(Key & 0xFFFF), int16(Key >> 16));
+    }
+
+    static FORCEINLINE uint32 HashKey(uint32 Key)
+    {
+        Key *= 0x9E3779B1u;
+        return Key ^ (Key >> 15);
+    }
+
+    friend FORCEINLINE FArchive& operator<<(FArchive& Ar, FHexMapCoord& Coord)
+    {
+        return Ar << Coord.x << Coord.y;
+    }
+
+    friend FORCEINLINE uint32 GetTypeHash(const FHexMapCoord& Coord)
+    {
+        return HashKey(Coord.Pack());
+    }
+
     FORCEINLINE FHexMapCoord operator * (const float rhs) const
     {
         FHexMapCoord lhs(*this);
@@ -73,6 +106,24 @@ public:
     }
 };
 
+//Packed per cell gameplay state, kept in step with the cell actors by AHexMap
+namespace EHexCellFlags
+{
+    enum Type : uint8
+    {
+        None = 0,
+        Exists = 1 << 0,
+        Traversable = 1 << 1, //Terrain only, occupancy is tracked separately
+        Occupied = 1 << 2,
+        Friendly = 1 << 3, //Set with Occupied when the occupant is friendly
+    };
+
+    FORCEINLINE bool BlocksSight(uint8 Flags)
+    {
+        return (Flags & (Exists | Traversable)) != (Exists | Traversable) || (Flags & Occupied) != 0;
+    }
+}
+
 static const TArray<FHexMapCoord>& GetDirectionsAt(const FHexMapCoord& Coord)
 {
     static const TArray<FHexMapCoord> EvenDirections = { {0,-1}, {1,0}, {0,1}, {-1,1}, {-1,0}, {-1,-1} };
@@ -100,8 +151,8 @@ public:
     TArray<AMapEntity*> Hits;
 };
 
-template<typename T> 
-static void Shuffle(TArray<T>& Array)
+template<typename T, typename AllocatorType> 
+static void Shuffle(TArray<T, AllocatorType>& Array)
 {
     int32 LastIndex = Array.Num() - 1;
     for (int32 i = 0; i < LastIndex; ++i)
@@ -112,4 +163,19 @@ static void Shuffle(TArray<T>& Array)
             Array.Swap(i, Index);
         }
     }
+}
+
+//Same as above drawing from Stream, so the order can be reproduced from its seed
+template<typename T, typename AllocatorType> 
+static void Shuffle(TArray<T, AllocatorType>& Array, const FRandomStream& Stream)
+{
+    int32 LastIndex = Array.Num() - 1;
+    for (int32 i = 0; i < LastIndex; ++i)
+    {
+        int32 Index = Stream.RandRange(0, LastIndex);
+        if (i != Index)
+        {
+            Array.Swap(i, Index);
+        }
+    }
 }
\ No newline at end of file
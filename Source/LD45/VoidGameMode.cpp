@@ -5,19 +5,105 @@
 #include "HexMap.h"
 #include "HexCell.h"
 #include "MapEntity.h"
+#include "GamePlayerController.h"
+#include "Engine/World.h"
 #include "PaperTileMapComponent.h"
 #include "Util.h"
+#include "HexAnimationScheduler.h"
+#include "Kismet/GameplayStatics.h"
+#include "Async/Async.h"
+#include "LD45Stats.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogVoidGameMode, Log, All)
 
 AVoidGameMode::AVoidGameMode()
 {
+    PrimaryActorTick.bCanEverTick = true;
+
+    AnimationScheduler = CreateDefaultSubobject<UHexAnimationScheduler>(TEXT("AnimationScheduler"));
+}
+
+void AVoidGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+    Super::InitGame(MapName, Options, ErrorMessage);
+
+    //Before any player is spawned, their decks shuffle from this
+    if (RandomSeed != 0)
+    {
+        RandomStream.Initialize(RandomSeed);
+    }
+    else
+    {
+        RandomStream.GenerateNewSeed();
+    }
 }
 
 void AVoidGameMode::BeginPlay()
 {
     Super::BeginPlay();
-    
+
+    FTurnArena::SetActive(&TurnArena);
+
+    EventQueue.OnDispatch.AddUObject(this, &AVoidGameMode::HandleGameplayEvents);
+
+    TryStartGame();
+}
+
+void AVoidGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (FTurnArena::GetActive() == &TurnArena)
+    {
+        FTurnArena::SetActive(nullptr);
+    }
+
+    PresentationTimeline.Reset();
+
+    if (PendingSave.IsValid())
+    {
+        PendingSave.Wait();
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void AVoidGameMode::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+
+    if (GetIsEnemyTurnRunning())
+    {
+        RunEnemyTurnSteps();
+    }
+
+    //Picks up whatever blueprint driven gameplay queued this frame
+    FlushGameplayEvents();
+
+    if (PresentationTimeline.IsPlaying())
+    {
+        AdvancePresentation(DeltaSeconds * PresentationPlayRate, FastForwardPresentation || !UsePresentationTimeline);
+    }
+}
+
+void AVoidGameMode::TryStartGame()
+{
+    if (CurrentFlowState != EGameFlowStateType::None)
+    {
+        return; //Already started
+    }
+
+    for (auto It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        if (auto Player = Cast<AGamePlayerController>(It->Get()))
+        {
+            if (!Player->GetIsDeckLoaded())
+            {
+                UE_LOG(LogVoidGameMode, Log, TEXT("[FlowState] Waiting on deck load for %s"), *GetNameSafe(Player));
+                Player->OnDeckLoaded.AddUniqueDynamic(this, &AVoidGameMode::HandlePlayerDeckLoaded);
+                return;
+            }
+        }
+    }
+
     CurrentFlowState = EGameFlowStateType::GameStart;
 
     UE_LOG(LogVoidGameMode, Log, TEXT("[FlowState] ==> %s"), *GETENUMSTRING(EGameFlowStateType, CurrentFlowState));
@@ -32,6 +118,14 @@ void AVoidGameMode::GotoFlowState(EGameFlowStateType NewState)
         return; //Already in this state
     }
 
+    if (!DeferFlowState(NewState, false))
+    {
+        EnterFlowStateForced(NewState);
+    }
+}
+
+bool AVoidGameMode::DeferFlowState(EGameFlowStateType NewState, bool IsForced)
+{
     if (IsGotoStateLocked)
     {
         if (PendingGotoState != EGameFlowStateType::None)
@@ -39,6 +133,26 @@ void AVoidGameMode::GotoFlowState(EGameFlowStateType NewState)
             UE_LOG(LogVoidGameMode, Log, TEXT("[FlowState] SKIPPED %s"), *GETENUMSTRING(EGameFlowStateType, PendingGotoState));
         }
         PendingGotoState = NewState;
+        IsPendingGotoForced = IsForced;
+        return true;
+    }
+    return false;
+}
+
+void AVoidGameMode::EnterFlowStateForced(EGameFlowStateType NewState)
+{
+    if (DeferFlowState(NewState, true))
+    {
+        return;
+    }
+
+    //Flow changes are a sync point, listeners see the board as it was left.
+    //Flushed before taking the lock so a transition they ask for, like game over, isn't skipped in favour of this one
+    const EGameFlowStateType StateBeforeFlush = CurrentFlowState;
+    FlushGameplayEvents();
+    if (CurrentFlowState != StateBeforeFlush)
+    {
+        UE_LOG(LogVoidGameMode, Log, TEXT("[FlowState] SKIPPED %s, superseded by %s"), *GETENUMSTRING(EGameFlowStateType, NewState), *GETENUMSTRING(EGameFlowStateType, CurrentFlowState));
         return;
     }
 
@@ -46,26 +160,115 @@ void AVoidGameMode::GotoFlowState(EGameFlowStateType NewState)
 
     IsGotoStateLocked = true;
 
-    ExitFlowState(CurrentFlowState);
-    OnExitFlowStateEvent.Broadcast(CurrentFlowState);
+    //The new state's visuals wait for the old state's to finish
+    PresentationTimeline.AddBarrier();
+
+    {
+        LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_FlowStateBroadcast);
+        ExitFlowState(CurrentFlowState);
+        OnExitFlowStateEvent.Broadcast(CurrentFlowState);
+    }
+
+    //Every telegraph has had its chance to land, unless they were just restored for the state being entered
+    if (CurrentFlowState == EGameFlowStateType::ResolveEnemyAttacks && !KeepTelegraphsOnExit)
+    {
+        ClearTelegraphedAttacks();
+    }
+    KeepTelegraphsOnExit = false;
 
     CurrentFlowState = NewState;
 
-    EnterFlowState(CurrentFlowState);
-    OnEnterFlowStateEvent.Broadcast(CurrentFlowState);
+    //Steps belong to the state that queued them
+    ClearEnemyTurnSteps();
+
+    //Turn counters read as totals for the last full loop
+    if (CurrentFlowState == EGameFlowStateType::GameLoopStart)
+    {
+        ResetTurnArena();
+
+        SET_DWORD_STAT(STAT_LD45_CellsTouched, 0);
+        SET_DWORD_STAT(STAT_LD45_EntitiesEvaluated, 0);
+        SET_DWORD_STAT(STAT_LD45_ArenaAllocations, 0);
+        SET_DWORD_STAT(STAT_LD45_ArenaBytes, 0);
+        SET_DWORD_STAT(STAT_LD45_EventsQueued, 0);
+
+        if (!AutosaveSlotName.IsEmpty())
+        {
+            SaveToSlot(AutosaveSlotName);
+        }
+    }
+
+    //A new game can't undo into the last one
+    if (CurrentFlowState == EGameFlowStateType::GameStart)
+    {
+        ClearUndoSnapshots();
+    }
+
+    if (CurrentFlowState == EGameFlowStateType::EnemyTurn)
+    {
+        PlanEnemyTurn();
+    }
+    else
+    {
+        EnemyTurnPlan.Reset();
+    }
+
+    if (UseEnemyTurnScheduler)
+    {
+        QueueEnemyTurnSteps(CurrentFlowState);
+    }
+
+    {
+        LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_FlowStateBroadcast);
+        EnterFlowState(CurrentFlowState);
+        OnEnterFlowStateEvent.Broadcast(CurrentFlowState);
+    }
 
     IsGotoStateLocked = false;
 
     if (PendingGotoState != EGameFlowStateType::None)
     {
         auto NextState = PendingGotoState;
+        const bool IsForced = IsPendingGotoForced;
         PendingGotoState = EGameFlowStateType::None;
-        GotoFlowState(NextState);
+        IsPendingGotoForced = false;
+        if (IsForced)
+        {
+            EnterFlowStateForced(NextState);
+        }
+        else
+        {
+            GotoFlowState(NextState);
+        }
     }
 }
 
+void AVoidGameMode::ResetTurnArena()
+{
+    UE_LOG(LogVoidGameMode, Log, TEXT("[Arena] Turn used %d allocations, %d of %d bytes"),
+        TurnArena.GetNumAllocations(), (int)TurnArena.GetBytesAllocated(), (int)TurnArena.GetCapacity());
+
+    TurnArena.Reset();
+}
+
 void AVoidGameMode::GotoNextFlowState()
 {
+    if (GetIsEnemyTurnRunning())
+    {
+        AdvanceWhenEnemyTurnDrains = true;
+        return;
+    }
+
+    if (UsePresentationTimeline)
+    {
+        FlushGameplayEvents();
+        if (PresentationTimeline.IsPlaying())
+        {
+            AdvanceWhenPresentationDrains = true;
+            return;
+        }
+    }
+
     if (CurrentFlowState == EGameFlowStateType::GameLoopEnd)
     {
         GotoFlowState(EGameFlowStateType::GameLoopStart);
@@ -97,15 +300,204 @@ void AVoidGameMode::SetShowPendingSpawns(bool Show)
 {
     if (HexMapActor)
     {
-        for (const auto& PendingSpawn : PendingSpawns)
+        if (Show)
         {
-            if (auto Cell = HexMapActor->GetCell(PendingSpawn.Location.x, PendingSpawn.Location.y))
+            TArray<FHexMapCoord> Locations;
+            Locations.Reserve(PendingSpawns.Num());
+            for (const auto& PendingSpawn : PendingSpawns)
             {
-                Cell->ShowPendingSpawn(Show);
+                Locations.Add(PendingSpawn.Location);
             }
+            HexMapActor->SetHighlightedCells(EHexHighlightChannel::PendingSpawn, Locations, FColor::White);
+        }
+        else
+        {
+            HexMapActor->ClearHighlightChannel(EHexHighlightChannel::PendingSpawn);
         }
     }
 }
+void AVoidGameMode::PlanEnemyTurn()
+{
+    LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_PlanEnemyTurn);
+
+    EnemyTurnPlan.Reset();
+
+    if (EnemyPlannerDepth <= 0 || !HexMapActor)
+    {
+        return;
+    }
+
+    FEnemyPlannerSettings Settings;
+    Settings.Depth = EnemyPlannerDepth;
+    Settings.BeamWidth = EnemyPlannerBeamWidth;
+    Settings.TimeBudgetMs = EnemyPlannerBudgetMs;
+
+    auto AllEntities = GetAllEntities();
+    FBoardSnapshot Board = FBoardSnapshot::Capture(HexMapActor, AllEntities);
+    FEnemyPlan Plan = FEnemyPlanner::Plan(Board, Settings);
+    INC_DWORD_STAT_BY(STAT_LD45_EntitiesEvaluated, Plan.StatesEvaluated);
+
+    if (Plan.IsValid)
+    {
+        for (const auto& Action : Plan.Actions)
+        {
+            EnemyTurnPlan.Add(AllEntities[Action.EntityIndex], { Action.Move, Action.AttackDirection });
+        }
+    }
+
+    UE_LOG(LogVoidGameMode, Log, TEXT("[Planner] %d turns, %d states, score %.1f"), Plan.TurnsSearched, Plan.StatesEvaluated, Plan.Score);
+}
+
+bool AVoidGameMode::GetPlannedEnemyAction(const AMapEntity* Entity, FHexMapCoord& OutMove, int& OutAttackDirection) const
+{
+    if (const FPlannedAction* Action = EnemyTurnPlan.Find(Entity))
+    {
+        OutMove = Action->Move;
+        OutAttackDirection = Action->AttackDirection;
+        return true;
+    }
+    return false;
+}
+
+void AVoidGameMode::AddTelegraphedAttack(AMapEntity* Entity, const FMapAttackInfo& Attack)
+{
+    RemoveTelegraphedAttack(Entity);
+
+    if (Entity && HexMapActor && Attack.Locations.Num() > 0)
+    {
+        TelegraphedAttacks.Add({ Entity, TelegraphedLocations.Num(), Attack.Locations.Num() });
+        TelegraphedLocations.Append(Attack.Locations);
+
+        HexMapActor->AddAttackOverlay(Attack.Locations);
+        HexMapActor->SetAttackInfluence(Entity, Attack.Locations);
+    }
+}
+
+bool AVoidGameMode::GetTelegraphedAttack(const AMapEntity* Entity, FMapAttackInfo& OutAttack) const
+{
+    for (const auto& Telegraph : TelegraphedAttacks)
+    {
+        if (Telegraph.Entity == Entity)
+        {
+            OutAttack.Locations.Reset();
+            OutAttack.Locations.Append(&TelegraphedLocations[Telegraph.FirstLocation], Telegraph.NumLocations);
+            OutAttack.Hits.Reset();
+            OutAttack.Damage = 1;
+            OutAttack.Source = const_cast<AMapEntity*>(Entity);
+            return true;
+        }
+    }
+    return false;
+}
+
+void AVoidGameMode::RemoveTelegraphedAttack(AMapEntity* Entity)
+{
+    const int Index = TelegraphedAttacks.IndexOfByPredicate([Entity](const FTelegraphedAttack& Telegraph) { return Telegraph.Entity == Entity; });
+    if (Index != INDEX_NONE)
+    {
+        //Its slice of the pool is only reclaimed by the next clear
+        const auto& Telegraph = TelegraphedAttacks[Index];
+        if (HexMapActor)
+        {
+            HexMapActor->RemoveAttackOverlay(MakeArrayView(&TelegraphedLocations[Telegraph.FirstLocation], Telegraph.NumLocations));
+            HexMapActor->SetAttackInfluence(Entity, TArray<FHexMapCoord>());
+        }
+        TelegraphedAttacks.RemoveAtSwap(Index);
+    }
+}
+
+void AVoidGameMode::ClearTelegraphedAttacks()
+{
+    if (HexMapActor)
+    {
+        HexMapActor->ClearAttackOverlay();
+        for (const auto& Telegraph : TelegraphedAttacks)
+        {
+            HexMapActor->SetAttackInfluence(Telegraph.Entity.Get(), TArray<FHexMapCoord>());
+        }
+    }
+    TelegraphedAttacks.Reset();
+    TelegraphedLocations.Reset();
+}
+
+float AVoidGameMode::GetEnemyTurnProgress() const
+{
+    return EnemyTurnSteps.Num() > 0 ? (float)EnemyTurnStepIndex / EnemyTurnSteps.Num() : 1.0f;
+}
+
+void AVoidGameMode::QueueEnemyTurnSteps(EGameFlowStateType FlowState)
+{
+    if (FlowState == EGameFlowStateType::ResolveEnemyAttacks)
+    {
+        for (auto Enemy : ActiveEnemies)
+        {
+            if (Enemy && Enemy->GetAIHasAttackPending())
+            {
+                EnemyTurnSteps.Add({ Enemy, EEnemyTurnStep::ResolveAttack });
+            }
+        }
+    }
+    else if (FlowState == EGameFlowStateType::EnemyTurn)
+    {
+        //Each enemy telegraphs from where it lands before the next one moves
+        for (auto Enemy : ActiveEnemies)
+        {
+            if (Enemy)
+            {
+                EnemyTurnSteps.Add({ Enemy, EEnemyTurnStep::Move });
+                EnemyTurnSteps.Add({ Enemy, EEnemyTurnStep::TelegraphAttack });
+            }
+        }
+    }
+
+    if (EnemyTurnSteps.Num() > 0)
+    {
+        UE_LOG(LogVoidGameMode, Log, TEXT("[Scheduler] Queued %d steps for %s"), EnemyTurnSteps.Num(), *GETENUMSTRING(EGameFlowStateType, FlowState));
+    }
+}
+
+void AVoidGameMode::RunEnemyTurnSteps()
+{
+    LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_EnemyTurnSteps);
+
+    //With the presentation timeline the simulation runs to completion, playback is what takes time
+    const double EndTime = UsePresentationTimeline ? MAX_dbl : FPlatformTime::Seconds() + EnemyTurnBudgetMs / 1000.0;
+    do
+    {
+        const FEnemyTurnStep& Step = EnemyTurnSteps[EnemyTurnStepIndex++];
+        AMapEntity* Enemy = Step.Entity.Get();
+        //Death bookkeeping waits for the next flush, so skip anything killed earlier in this slice
+        if (Enemy && Enemy->GetHealth() > 0)
+        {
+            switch (Step.Step)
+            {
+            case EEnemyTurnStep::Move: Enemy->AIMove(); break;
+            case EEnemyTurnStep::TelegraphAttack: Enemy->AITelegraphAttack(); break;
+            case EEnemyTurnStep::ResolveAttack: Enemy->AIResolveAttack(); break;
+            }
+        }
+    } while (GetIsEnemyTurnRunning() && FPlatformTime::Seconds() < EndTime);
+
+    FlushGameplayEvents();
+
+    if (!GetIsEnemyTurnRunning())
+    {
+        const bool Advance = AdvanceWhenEnemyTurnDrains;
+        ClearEnemyTurnSteps();
+        if (Advance)
+        {
+            GotoNextFlowState();
+        }
+    }
+}
+
+void AVoidGameMode::ClearEnemyTurnSteps()
+{
+    EnemyTurnSteps.Reset();
+    EnemyTurnStepIndex = 0;
+    AdvanceWhenEnemyTurnDrains = false;
+}
+
 void AVoidGameMode::EnterFlowState_Implementation(EGameFlowStateType FlowState)
 {
 }
@@ -120,7 +512,12 @@ AMapEntity* AVoidGameMode::SpawnEntityOnCell(class AHexCell* Cell, TSubclassOf<A
     {
         if(auto Occupier = Cell->GetOccupyingEntity())
         {
+            //The dead are off the board straight away, their death goes out with the rest of the batch
             Occupier->Kill();
+            if (Occupier->GetHealth() == 0 && Cell->GetOccupyingEntity() == Occupier)
+            {
+                Occupier->LeaveMapCell();
+            }
         }
         if(Cell->GetOccupyingEntity() != nullptr)
         {
@@ -134,7 +531,6 @@ AMapEntity* AVoidGameMode::SpawnEntityOnCell(class AHexCell* Cell, TSubclassOf<A
             Entity->MoveToMapCell(Cell);
             
             Entity->OnDestroyed.AddDynamic(this, &AVoidGameMode::HandleEntityDestroyed);
-            Entity->OnDeath.AddDynamic(this, &AVoidGameMode::HandleEntityDeath);
 
             auto& ActiveSet = Entity->GetIsFriendly() ? ActiveFriendlies : ActiveEnemies;
             ActiveSet.Emplace(Entity);
@@ -150,21 +546,270 @@ AMapEntity* AVoidGameMode::SpawnEntityAtLocation(const FHexMapCoord& Location, T
 {
     if (ensure(HexMapActor))
     {
-        return SpawnEntityOnCell(HexMapActor->GetCell(Location.x, Location.y), EntityClass);
+        return SpawnEntityOnCell(HexMapActor->GetOrLoadCell(Location.x, Location.y), EntityClass);
     }
     return nullptr;
 }
 
+bool AVoidGameMode::ExecuteCardEffects(const TArray<UCardEffect*>& Effects, FCardEffectContext Context)
+{
+    if (!Context.Map)
+    {
+        Context.Map = HexMapActor;
+    }
+
+    FBoardCommandList Commands;
+    for (const UCardEffect* Effect : Effects)
+    {
+        if (Effect)
+        {
+            if (!Effect->CanTarget(Context))
+            {
+                UE_LOG(LogVoidGameMode, Log, TEXT("[Effect] %s can't target (%d,%d)"), *GetNameSafe(Effect), Context.Target.x, Context.Target.y);
+                return false;
+            }
+            Effect->Compile(Context, Commands);
+        }
+    }
+
+    if (Commands.Num() == 0 || !ValidateBoardCommands(Commands))
+    {
+        return false;
+    }
+
+    PushUndoSnapshot();
+    ApplyBoardCommands(Commands);
+    return true;
+}
+
+bool AVoidGameMode::ValidateBoardCommands(const FBoardCommandList& Commands) const
+{
+    if (!HexMapActor)
+    {
+        return false;
+    }
+
+    //Occupancy changes made by earlier commands in the list
+    TMap<const AHexCell*, bool> OccupancyOverrides;
+    auto IsOccupied = [&OccupancyOverrides](const AHexCell* Cell)
+    {
+        if (const bool* Occupied = OccupancyOverrides.Find(Cell))
+        {
+            return *Occupied;
+        }
+        return Cell->GetOccupyingEntity() != nullptr;
+    };
+
+    for (const auto& Command : Commands)
+    {
+        const AHexCell* Cell = HexMapActor->GetOrLoadCell(Command.Target.x, Command.Target.y);
+        bool IsValid = Cell != nullptr;
+
+        switch (Command.Type)
+        {
+        case EBoardCommandType::Spawn:
+            //Spawning on an occupied cell kills the occupier, only the terrain matters
+            IsValid &= Cell && Command.EntityClass && Cell->GetIsAttackable();
+            if (IsValid)
+            {
+                OccupancyOverrides.Add(Cell, true);
+            }
+            break;
+        case EBoardCommandType::Move:
+        {
+            const AHexCell* ToCell = HexMapActor->GetOrLoadCell(Command.Destination.x, Command.Destination.y);
+            //Terrain from the flags, occupancy from the overrides so earlier commands count
+            const bool IsDestinationTraversable = ToCell && (HexMapActor->GetCellFlags()[HexMapActor->GetCellIndex(Command.Destination)] & EHexCellFlags::Traversable);
+            IsValid &= Cell && IsOccupied(Cell) && IsDestinationTraversable && !IsOccupied(ToCell);
+            if (IsValid)
+            {
+                OccupancyOverrides.Add(Cell, false);
+                OccupancyOverrides.Add(ToCell, true);
+            }
+            break;
+        }
+        case EBoardCommandType::Buff:
+            IsValid &= Cell && IsOccupied(Cell);
+            break;
+        case EBoardCommandType::Damage:
+            break;
+        }
+
+        if (!IsValid)
+        {
+            UE_LOG(LogVoidGameMode, Log, TEXT("[Effect] INVALID command %d at (%d,%d)"), (int)Command.Type, Command.Target.x, Command.Target.y);
+            return false;
+        }
+    }
+    return true;
+}
+
+void AVoidGameMode::ApplyBoardCommands(const FBoardCommandList& Commands)
+{
+    LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_ApplyBoardCommands);
+
+    if (!HexMapActor)
+    {
+        return;
+    }
+
+    //Entities hold their native health events until the whole batch is on the board
+    TGuardValue<bool> ApplyingGuard(IsApplyingBoardCommands, true);
+    BatchedHealthEvents.Reset();
+
+    //Damage is summed per entity so each one only changes health once
+    TMap<AMapEntity*, int> PendingDamage;
+
+    for (const auto& Command : Commands)
+    {
+        AHexCell* Cell = HexMapActor->GetOrLoadCell(Command.Target.x, Command.Target.y);
+        AMapEntity* Entity = Cell ? Cell->GetOccupyingEntity() : nullptr;
+
+        switch (Command.Type)
+        {
+        case EBoardCommandType::Spawn:
+            SpawnEntityOnCell(Cell, Command.EntityClass);
+            break;
+        case EBoardCommandType::Move:
+            if (Entity)
+            {
+                Entity->MoveToMapCell(HexMapActor->GetOrLoadCell(Command.Destination.x, Command.Destination.y));
+            }
+            break;
+        case EBoardCommandType::Buff:
+            if (Entity)
+            {
+                Entity->SetMaxHealth(Entity->GetMaxHealth() + Command.Amount);
+                Entity->SetHealth(Entity->GetHealth() + Command.Amount);
+            }
+            break;
+        case EBoardCommandType::Damage:
+            if (Entity)
+            {
+                PendingDamage.FindOrAdd(Entity) += Command.Amount;
+            }
+            break;
+        }
+    }
+
+    for (const auto& Damage : PendingDamage)
+    {
+        if (IsValid(Damage.Key))
+        {
+            FDamageEvent DamageEvent;
+            Damage.Key->TakeDamage(Damage.Value, DamageEvent, nullptr, nullptr);
+        }
+    }
+
+    //One HealthChanged per entity however many commands touched it, with the timeline these play as it does
+    if (!UsePresentationTimeline)
+    {
+        for (auto Entity : BatchedHealthEvents)
+        {
+            if (IsValid(Entity))
+            {
+                Entity->PresentHealthChanged();
+                if (Entity->GetHealth() == 0)
+                {
+                    Entity->PresentDeath();
+                }
+            }
+        }
+    }
+    BatchedHealthEvents.Reset();
+
+    FlushGameplayEvents();
+
+    OnBoardChanged.Broadcast(this);
+}
+
+void AVoidGameMode::DeferEntityHealthEvents(AMapEntity* Entity)
+{
+    check(IsApplyingBoardCommands);
+    BatchedHealthEvents.AddUnique(Entity);
+}
+
+void AVoidGameMode::HandlePlayerDeckLoaded(AGamePlayerController* Player)
+{
+    if (Player)
+    {
+        Player->OnDeckLoaded.RemoveDynamic(this, &AVoidGameMode::HandlePlayerDeckLoaded);
+    }
+    TryStartGame();
+}
+
 void AVoidGameMode::HandleEntityDestroyed(AActor* Entity)
 {
     ActiveEnemies.Remove(Cast<AMapEntity>(Entity));
     ActiveFriendlies.Remove(Cast<AMapEntity>(Entity));
 }
 
+void AVoidGameMode::FlushGameplayEvents()
+{
+    //The timeline broadcasts the blueprint delegates as it plays instead
+    EventQueue.SetBlueprintAdapterEnabled(!UsePresentationTimeline);
+    EventQueue.Flush();
+}
+
+void AVoidGameMode::SkipPresentation()
+{
+    FlushGameplayEvents();
+    AdvancePresentation(0.0f, true);
+}
+
+void AVoidGameMode::AdvancePresentation(float DeltaTime, bool Skip)
+{
+    {
+        LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_Presentation);
+        if (Skip)
+        {
+            PresentationTimeline.SkipToEnd();
+        }
+        else
+        {
+            PresentationTimeline.Advance(DeltaTime);
+        }
+    }
+
+    if (!PresentationTimeline.IsPlaying() && AdvanceWhenPresentationDrains)
+    {
+        AdvanceWhenPresentationDrains = false;
+        GotoNextFlowState();
+    }
+}
+
+void AVoidGameMode::HandleGameplayEvents(TArrayView<const FGameplayEvent> Events, const FGameplayEventQueue& Queue)
+{
+    if (UsePresentationTimeline)
+    {
+        PresentationTimeline.Record(Events, Queue);
+    }
+
+    for (const auto& Event : Events)
+    {
+        if (Event.Type == EGameplayEventType::Death)
+        {
+            if (Event.Entity)
+            {
+                HandleEntityDeath(Event.Entity);
+            }
+        }
+    }
+}
+
 void AVoidGameMode::HandleEntityDeath(AMapEntity* Entity)
 {
     ActiveEnemies.Remove(Entity);
     ActiveFriendlies.Remove(Entity);
+
+    //The dead don't get their remaining steps
+    for (int i = EnemyTurnStepIndex; i < EnemyTurnSteps.Num(); i++)
+    {
+        if (EnemyTurnSteps[i].Entity == Entity)
+        {
+            EnemyTurnSteps[i].Entity = nullptr;
+        }
+    }
 }
 
 void AVoidGameMode::DestroyAllEntities()
@@ -178,7 +823,7 @@ void AVoidGameMode::DestroyAllEntities()
 
 TSubclassOf<AMapEntity> AVoidGameMode::PickRandomEnemyType() const
 {
-    int Index = FMath::RandRange(0, EnemyTypes.Num() - 1);
+    int Index = RandomStream.RandRange(0, EnemyTypes.Num() - 1);
     if (EnemyTypes.IsValidIndex(Index))
     {
         return EnemyTypes[Index];
@@ -190,10 +835,11 @@ bool AVoidGameMode::FindRandomEnemySpawnLocation(FHexMapCoord& OutCoord) const
 {
     if (HexMapActor)
     {
-        auto ValidLocations = HexMapActor->GetValidEnemySpawnLocations();
+        TTurnArray<FHexMapCoord> ValidLocations;
+        HexMapActor->GatherValidEnemySpawnLocations(ValidLocations);
         if (ValidLocations.Num() > 0)
         {
-            OutCoord = ValidLocations[FMath::RandRange(0, ValidLocations.Num() - 1)];
+            OutCoord = ValidLocations[RandomStream.RandRange(0, ValidLocations.Num() - 1)];
             return true;
         }
     }
@@ -209,6 +855,8 @@ void AVoidGameMode::AddFirstPendingSpawns()
 
 void AVoidGameMode::SpawnEnemies()
 {
+    LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_SpawnEnemies);
+
     if (HexMapActor)
     {
         for (const auto& Spawn : PendingSpawns)
@@ -223,8 +871,11 @@ void AVoidGameMode::SpawnEnemies()
 
 void AVoidGameMode::AddPendingSpawns()
 {
-    auto ValidLocations = HexMapActor->GetValidEnemySpawnLocations();
-    Shuffle(ValidLocations);
+    LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_AddPendingSpawns);
+
+    TTurnArray<FHexMapCoord> ValidLocations;
+    HexMapActor->GatherValidEnemySpawnLocations(ValidLocations);
+    Shuffle(ValidLocations, RandomStream);
 
     int MaxEnemies = 5;
     int EnemiesToSpawn = FMath::Min(3, MaxEnemies - ActiveEnemies.Num());
@@ -238,4 +889,301 @@ void AVoidGameMode::AddPendingSpawns()
     }
 
     SetShowPendingSpawns(true);
+}
+
+void AVoidGameMode::CaptureSnapshot(FGameStateSnapshot& Snapshot) const
+{
+    LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_Snapshot);
+
+    Snapshot.Reset();
+    Snapshot.MapId = HexMapActor ? HexMapActor->GetMapId() : FString();
+    Snapshot.FlowState = (uint8)CurrentFlowState;
+    Snapshot.RandomSeed = RandomStream.GetCurrentSeed();
+
+    TMap<const AMapEntity*, int> EntityIndices;
+    for (const AMapEntity* Entity : GetAllEntities())
+    {
+        const AHexCell* Cell = Entity ? Entity->GetMapCell() : nullptr;
+        if (!Cell || Entity->GetHealth() <= 0)
+        {
+            continue;
+        }
+
+        EntityIndices.Add(Entity, Snapshot.Entities.Num());
+
+        FGameStateSnapshot::FEntityRecord Record;
+        FMemory::Memzero(Record);
+        Record.Coord = Cell->GetMapCoord();
+        Record.Class = (int16)Snapshot.AddObject(Entity->GetClass());
+        Record.Health = (int16)Entity->GetHealth();
+        Record.MaxHealth = (int16)Entity->GetMaxHealth();
+        Record.IsAttackPending = Entity->GetAIHasAttackPending();
+        Snapshot.Entities.Add(Record);
+    }
+
+    for (const auto& Spawn : PendingSpawns)
+    {
+        Snapshot.PendingSpawns.Add({ Spawn.Location, Snapshot.AddObject(Spawn.EntityClass.Get()) });
+    }
+
+    for (const auto& Telegraph : TelegraphedAttacks)
+    {
+        if (const int* EntityIndex = EntityIndices.Find(Telegraph.Entity.Get()))
+        {
+            Snapshot.Attacks.Add({ *EntityIndex, Snapshot.AttackLocations.Num(), Telegraph.NumLocations });
+            Snapshot.AttackLocations.Append(&TelegraphedLocations[Telegraph.FirstLocation], Telegraph.NumLocations);
+        }
+    }
+
+    for (auto It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        if (auto Player = Cast<AGamePlayerController>(It->Get()))
+        {
+            Player->CaptureCards(Snapshot);
+            break;
+        }
+    }
+}
+
+bool AVoidGameMode::RestoreSnapshot(const FGameStateSnapshot& Snapshot, bool ReenterFlowState)
+{
+    if (!HexMapActor)
+    {
+        return false;
+    }
+
+    LD45_SCOPE_CYCLE_COUNTER(STAT_LD45_Snapshot);
+
+    //Nothing in flight belongs to the restored state, though deaths still playing have to happen so their actors go
+    FlushGameplayEvents();
+    PresentationTimeline.SkipToEnd();
+    AdvanceWhenPresentationDrains = false;
+    ClearEnemyTurnSteps();
+    ClearTelegraphedAttacks();
+    SetShowPendingSpawns(false);
+    EnemyTurnPlan.Reset();
+
+    //Live entities are reused by class, everything leaves its cell first so records can land in any order.
+    //This happens before the map is swapped, a new map destroys the cells they're leaving
+    TMap<UClass*, TArray<AMapEntity*>> EntityPool;
+    TArray<TPair<AMapEntity*, AHexCell*>> OldCells;
+    for (auto Entity : GetAllEntities())
+    {
+        if (Entity)
+        {
+            OldCells.Emplace(Entity, Entity->GetMapCell());
+            Entity->LeaveMapCell();
+            EntityPool.FindOrAdd(Entity->GetClass()).Add(Entity);
+        }
+    }
+
+    if (Snapshot.MapId != HexMapActor->GetMapId() && !HexMapActor->SetMapId(Snapshot.MapId))
+    {
+        UE_LOG(LogVoidGameMode, Error, TEXT("[Snapshot] Can't restore map %s"), *Snapshot.MapId);
+
+        //The old map is still up, entities go back where they were
+        for (const auto& OldCell : OldCells)
+        {
+            OldCell.Key->RestoreState(OldCell.Value, OldCell.Key->GetHealth(), OldCell.Key->GetMaxHealth(), OldCell.Key->GetAIHasAttackPending());
+        }
+        return false;
+    }
+
+    ActiveEnemies.Reset();
+    ActiveFriendlies.Reset();
+
+    TArray<AMapEntity*> RestoredEntities;
+    RestoredEntities.Init(nullptr, Snapshot.Entities.Num());
+    for (int i = 0; i < Snapshot.Entities.Num(); i++)
+    {
+        const auto& Record = Snapshot.Entities[i];
+        UClass* EntityClass = Snapshot.ResolveObject<UClass>(Record.Class);
+        AHexCell* Cell = HexMapActor->GetOrLoadCell(Record.Coord.x, Record.Coord.y);
+        if (!EntityClass || !EntityClass->IsChildOf(AMapEntity::StaticClass()) || !Cell)
+        {
+            UE_LOG(LogVoidGameMode, Warning, TEXT("[Snapshot] Dropped entity %d at (%d,%d)"), i, Record.Coord.x, Record.Coord.y);
+            continue;
+        }
+
+        AMapEntity* Entity = nullptr;
+        if (auto Pool = EntityPool.Find(EntityClass))
+        {
+            Entity = Pool->Num() > 0 ? Pool->Pop(false) : nullptr;
+        }
+        if (!Entity)
+        {
+            Entity = GetWorld()->SpawnActor<AMapEntity>(EntityClass);
+            if (!Entity)
+            {
+                continue;
+            }
+            Entity->OnDestroyed.AddDynamic(this, &AVoidGameMode::HandleEntityDestroyed);
+        }
+
+        Entity->RestoreState(Cell, Record.Health, Record.MaxHealth, Record.IsAttackPending != 0);
+
+        auto& ActiveSet = Entity->GetIsFriendly() ? ActiveFriendlies : ActiveEnemies;
+        ActiveSet.Add(Entity);
+        RestoredEntities[i] = Entity;
+    }
+
+    //Whatever wasn't reused isn't in the snapshot
+    for (auto& Pool : EntityPool)
+    {
+        for (auto Entity : Pool.Value)
+        {
+            Entity->Destroy();
+        }
+    }
+
+    PendingSpawns.Reset(Snapshot.PendingSpawns.Num());
+    for (const auto& Record : Snapshot.PendingSpawns)
+    {
+        UClass* EntityClass = Snapshot.ResolveObject<UClass>(Record.Class);
+        if (EntityClass && EntityClass->IsChildOf(AMapEntity::StaticClass()))
+        {
+            PendingSpawns.Emplace(EntityClass, Record.Location);
+        }
+    }
+    SetShowPendingSpawns(PendingSpawns.Num() > 0);
+
+    FMapAttackInfo Attack;
+    for (const auto& Record : Snapshot.Attacks)
+    {
+        const bool IsValidSlice = Record.FirstLocation >= 0 && Record.NumLocations > 0 && Record.FirstLocation + Record.NumLocations <= Snapshot.AttackLocations.Num();
+        AMapEntity* Entity = RestoredEntities.IsValidIndex(Record.Entity) ? RestoredEntities[Record.Entity] : nullptr;
+        if (Entity && IsValidSlice)
+        {
+            Attack.Locations.Reset();
+            Attack.Locations.Append(&Snapshot.AttackLocations[Record.FirstLocation], Record.NumLocations);
+            Attack.Source = Entity;
+            AddTelegraphedAttack(Entity, Attack);
+        }
+    }
+
+    for (auto It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        if (auto Player = Cast<AGamePlayerController>(It->Get()))
+        {
+            Player->RestoreCards(Snapshot);
+            break;
+        }
+    }
+
+    RandomStream.Initialize(Snapshot.RandomSeed);
+
+    UE_LOG(LogVoidGameMode, Log, TEXT("[Snapshot] Restored %d entities in %s"), Snapshot.Entities.Num(), *GETENUMSTRING(EGameFlowStateType, (EGameFlowStateType)Snapshot.FlowState));
+
+    OnBoardChanged.Broadcast(this);
+
+    const auto SavedFlowState = (EGameFlowStateType)Snapshot.FlowState;
+    if (ReenterFlowState)
+    {
+        //Leaves whatever state we were in and enters the saved one, even when they're the same
+        KeepTelegraphsOnExit = true;
+        EnterFlowStateForced(SavedFlowState);
+    }
+    else
+    {
+        CurrentFlowState = SavedFlowState;
+    }
+    return true;
+}
+
+void AVoidGameMode::PushUndoSnapshot()
+{
+    if (UndoDepth <= 0)
+    {
+        return;
+    }
+
+    if (UndoSnapshots.Num() != UndoDepth)
+    {
+        UndoSnapshots.SetNum(UndoDepth);
+        UndoHead = 0;
+        NumUndoSnapshots = 0;
+    }
+
+    FlushGameplayEvents();
+    CaptureSnapshot(ScratchSnapshot);
+    ScratchSnapshot.Write(UndoSnapshots[UndoHead]);
+
+    UndoHead = (UndoHead + 1) % UndoSnapshots.Num();
+    NumUndoSnapshots = FMath::Min(NumUndoSnapshots + 1, UndoSnapshots.Num());
+}
+
+bool AVoidGameMode::Undo()
+{
+    if (NumUndoSnapshots == 0 || UndoSnapshots.Num() == 0)
+    {
+        return false;
+    }
+
+    //The history only shrinks once the snapshot is known to read
+    const int Head = (UndoHead + UndoSnapshots.Num() - 1) % UndoSnapshots.Num();
+    if (!ScratchSnapshot.Read(UndoSnapshots[Head]))
+    {
+        return false;
+    }
+
+    UndoHead = Head;
+    NumUndoSnapshots--;
+    return RestoreSnapshot(ScratchSnapshot, ScratchSnapshot.FlowState != (uint8)CurrentFlowState);
+}
+
+void AVoidGameMode::ClearUndoSnapshots()
+{
+    //Buffers are kept for reuse
+    UndoHead = 0;
+    NumUndoSnapshots = 0;
+}
+
+bool AVoidGameMode::SaveToSlot(const FString& SlotName)
+{
+    if (PendingSave.IsValid() && !PendingSave.IsReady())
+    {
+        UE_LOG(LogVoidGameMode, Warning, TEXT("[Snapshot] Skipped saving to %s, the last save is still being written"), *SlotName);
+        return false;
+    }
+
+    FlushGameplayEvents();
+    CaptureSnapshot(ScratchSnapshot);
+
+    TArray<uint8> Bytes;
+    ScratchSnapshot.Write(Bytes);
+
+    UE_LOG(LogVoidGameMode, Log, TEXT("[Snapshot] Saving %d bytes to %s"), Bytes.Num(), *SlotName);
+
+    //Disk IO stays off the game thread
+    PendingSave = Async(EAsyncExecution::ThreadPool, [Bytes = MoveTemp(Bytes), SlotName]()
+    {
+        return UGameplayStatics::SaveDataToSlot(Bytes, SlotName, 0);
+    });
+    return true;
+}
+
+bool AVoidGameMode::LoadFromSlot(const FString& SlotName)
+{
+    if (PendingSave.IsValid())
+    {
+        PendingSave.Wait();
+    }
+
+    TArray<uint8> Bytes;
+    if (!UGameplayStatics::LoadDataFromSlot(Bytes, SlotName, 0) || !ScratchSnapshot.Read(Bytes))
+    {
+        UE_LOG(LogVoidGameMode, Error, TEXT("[Snapshot] Failed to load %s"), *SlotName);
+        return false;
+    }
+
+    //Undo history belongs to the game being replaced
+    ClearUndoSnapshots();
+    return RestoreSnapshot(ScratchSnapshot, true);
+}
+
+int AVoidGameMode::RandRange(const UObject* WorldContextObject, int Min, int Max)
+{
+    UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+    AVoidGameMode* GameMode = World ? World->GetAuthGameMode<AVoidGameMode>() : nullptr;
+    return GameMode ? GameMode->RandomStream.RandRange(Min, Max) : FMath::RandRange(Min, Max);
 }
\ No newline at end of file
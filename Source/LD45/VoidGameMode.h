@@ -5,9 +5,19 @@
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
 #include "Util.h"
+#include "CardEffect.h"
+#include "EnemyPlanner.h"
+#include "TurnArena.h"
+#include "GameplayEventQueue.h"
+#include "PresentationTimeline.h"
+#include "GameStateSnapshot.h"
+#include "Async/Future.h"
 #include "VoidGameMode.generated.h"
 
 class AMapEntity;
+class AGamePlayerController;
+class UCardEffect;
+class UHexAnimationScheduler;
 
 UENUM(BlueprintType)
 enum class EGameFlowStateType : uint8
@@ -63,13 +73,21 @@ class LD45_API AVoidGameMode : public AGameModeBase
 {
 	GENERATED_BODY()
 
+    friend class FLD45Benchmark;
+
 public:
 
     AVoidGameMode();
 
 protected:
 
+    void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
     void BeginPlay() override;
+    void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+
+    void Tick(float DeltaSeconds) override;
 	
 public:
 
@@ -97,6 +115,87 @@ public:
     UFUNCTION(BlueprintCallable)
     void SetShowPendingSpawns(bool Show);
 
+    //Runs the lookahead planner for the coming enemy turn, a no-op when EnemyPlannerDepth is 0
+    UFUNCTION(BlueprintCallable)
+    void PlanEnemyTurn();
+
+    bool GetPlannedEnemyAction(const AMapEntity* Entity, FHexMapCoord& OutMove, int& OutAttackDirection) const;
+
+    //Records an enemy's telegraphed attack and lights it on the map's attack overlay, replacing any it already had
+    void AddTelegraphedAttack(AMapEntity* Entity, const FMapAttackInfo& Attack);
+
+    //Rebuilds a telegraphed attack for resolving, the overlay stays up until ResolveEnemyAttacks ends
+    bool GetTelegraphedAttack(const AMapEntity* Entity, FMapAttackInfo& OutAttack) const;
+
+    void RemoveTelegraphedAttack(AMapEntity* Entity);
+
+    //Drops every telegraph and resets the overlay in one go
+    void ClearTelegraphedAttacks();
+
+    FGameplayEventQueue& GetEventQueue() { return EventQueue; }
+
+    //Sync point, hands queued gameplay events to listeners and blueprint delegates. Also runs every tick and on flow changes
+    UFUNCTION(BlueprintCallable)
+    void FlushGameplayEvents();
+
+    UFUNCTION(BlueprintPure)
+    UHexAnimationScheduler* GetAnimationScheduler() const { return AnimationScheduler; }
+
+    //True while enemy AI steps queued by the turn scheduler are still running
+    UFUNCTION(BlueprintPure)
+    bool GetIsEnemyTurnRunning() const { return EnemyTurnStepIndex < EnemyTurnSteps.Num(); }
+
+    //0-1 through the queued enemy AI steps, 1 when nothing is queued
+    UFUNCTION(BlueprintPure)
+    float GetEnemyTurnProgress() const;
+
+    //True while recorded moves, attacks and deaths are still playing back, GotoNextFlowState waits for them
+    UFUNCTION(BlueprintPure)
+    bool GetIsPresentationPlaying() const { return PresentationTimeline.IsPlaying(); }
+
+    UFUNCTION(BlueprintPure)
+    float GetPresentationTimeRemaining() const { return PresentationTimeline.GetTimeRemaining(); }
+
+    //Plays out everything recorded so far instantly
+    UFUNCTION(BlueprintCallable)
+    void SkipPresentation();
+
+    //Packs the whole game into Snapshot. Flush gameplay events first so deaths have been handled
+    void CaptureSnapshot(FGameStateSnapshot& Snapshot) const;
+
+    //Puts the game back as captured, reusing entity actors of the same class and spawning the rest.
+    //ReenterFlowState re-enters the captured state so blueprint picks up from there, otherwise it's set silently
+    bool RestoreSnapshot(const FGameStateSnapshot& Snapshot, bool ReenterFlowState);
+
+    //Records the current state for Undo, also done before each card's effects are applied
+    UFUNCTION(BlueprintCallable)
+    void PushUndoSnapshot();
+
+    //Restores the last undo snapshot, false if there is none
+    UFUNCTION(BlueprintCallable)
+    bool Undo();
+
+    UFUNCTION(BlueprintPure)
+    int GetNumUndoSnapshots() const { return NumUndoSnapshots; }
+
+    UFUNCTION(BlueprintCallable)
+    void ClearUndoSnapshots();
+
+    //Captures on the game thread and writes on a background one, false if the last save is still being written
+    UFUNCTION(BlueprintCallable)
+    bool SaveToSlot(const FString& SlotName);
+
+    UFUNCTION(BlueprintCallable)
+    bool LoadFromSlot(const FString& SlotName);
+
+    const FRandomStream& GetRandomStream() const { return RandomStream; }
+
+    //Gameplay rolls go through the game mode's stream so snapshots restore them too, plain FMath without a VoidGameMode
+    static int RandRange(const UObject* WorldContextObject, int Min, int Max);
+
+    //Logs the finished turn's scratch usage and rewinds the arena, called on entering GameLoopStart
+    void ResetTurnArena();
+
 protected:
 
     UFUNCTION(BlueprintNativeEvent)
@@ -115,14 +214,34 @@ public:
     UFUNCTION(BlueprintCallable)
     AMapEntity* SpawnEntityAtLocation(const FHexMapCoord& Location, TSubclassOf<AMapEntity> EntityClass);
 
+    //Compiles the effects into board commands, validates them and applies them as a single batch
+    UFUNCTION(BlueprintCallable)
+    bool ExecuteCardEffects(const TArray<UCardEffect*>& Effects, FCardEffectContext Context);
+
+    bool ValidateBoardCommands(const FBoardCommandList& Commands) const;
+
+    void ApplyBoardCommands(const FBoardCommandList& Commands);
+
+    //While ApplyBoardCommands runs, entities hand their native HealthChanged and Death to the batch
+    bool GetIsApplyingBoardCommands() const { return IsApplyingBoardCommands; }
+    void DeferEntityHealthEvents(AMapEntity* Entity);
+
 protected:
 
+    //Enters GameStart once every player's deck has streamed in
+    void TryStartGame();
+
+    UFUNCTION()
+    void HandlePlayerDeckLoaded(AGamePlayerController* Player);
+
     UFUNCTION()
     void HandleEntityDestroyed(AActor* Entity);
 
     UFUNCTION()
     void HandleEntityDeath(AMapEntity* Entity);
 
+    void HandleGameplayEvents(TArrayView<const FGameplayEvent> Events, const FGameplayEventQueue& Queue);
+
     UFUNCTION()
     void DestroyAllEntities();
 
@@ -139,6 +258,22 @@ protected:
     UFUNCTION(BlueprintCallable)
     void AddPendingSpawns();
 
+    //GotoFlowState without the same state check, exits the current state and enters NewState regardless
+    void EnterFlowStateForced(EGameFlowStateType NewState);
+
+    //Holds NewState back while a transition is running, true if it was deferred
+    bool DeferFlowState(EGameFlowStateType NewState, bool IsForced);
+
+    //Queues the AI steps for EnemyTurn and ResolveEnemyAttacks in the same order a synchronous pass would run them
+    void QueueEnemyTurnSteps(EGameFlowStateType FlowState);
+
+    //Runs queued steps until the frame budget is spent, always at least one
+    void RunEnemyTurnSteps();
+
+    void ClearEnemyTurnSteps();
+
+    void AdvancePresentation(float DeltaTime, bool Skip);
+
 public:
 
     UPROPERTY(BlueprintAssignable)
@@ -147,9 +282,53 @@ public:
     UPROPERTY(BlueprintAssignable)
     FFlowStateEvent OnExitFlowStateEvent;
 
+    //Broadcast once after a batch of board commands has been applied
+    UPROPERTY(BlueprintAssignable)
+    FVoidGameModeEvent OnBoardChanged;
+
     UPROPERTY(EditDefaultsOnly)
     TArray<TSubclassOf<AMapEntity>> EnemyTypes;
 
+    //Enemy turns to look ahead, 0 keeps the greedy per-enemy AI
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = AI)
+    int EnemyPlannerDepth = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = AI)
+    int EnemyPlannerBeamWidth = 16;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = AI)
+    float EnemyPlannerBudgetMs = 8.0f;
+
+    //Runs enemy moves, telegraphs and attacks natively over several frames instead of from blueprint
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = AI)
+    bool UseEnemyTurnScheduler = false;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = AI, meta = (EditCondition = "UseEnemyTurnScheduler"))
+    float EnemyTurnBudgetMs = 4.0f;
+
+    //Simulates turns instantly and plays their moves, attacks and deaths back afterwards, overlapping different entities
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Presentation)
+    bool UsePresentationTimeline = false;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Presentation, meta = (EditCondition = "UsePresentationTimeline"))
+    float PresentationPlayRate = 1.0f;
+
+    //Turbo mode, recorded commands are applied without animating
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Presentation, meta = (EditCondition = "UsePresentationTimeline"))
+    bool FastForwardPresentation = false;
+
+    //Seeds every gameplay roll, 0 picks a new seed each game
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Save)
+    int RandomSeed = 0;
+
+    //Snapshots kept for Undo, each card played captures one. 0 turns undo off
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Save, meta = (ClampMin = 0))
+    int UndoDepth = 0;
+
+    //Saved on entering GameLoopStart, empty turns autosaves off
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Save)
+    FString AutosaveSlotName;
+
 protected:
 
     UPROPERTY(BlueprintReadWrite)
@@ -157,17 +336,89 @@ protected:
 
 private:
 
-    EGameFlowStateType CurrentFlowState;
+    EGameFlowStateType CurrentFlowState = EGameFlowStateType::None;
 
     bool IsGotoStateLocked = false;
-    EGameFlowStateType PendingGotoState;
+    EGameFlowStateType PendingGotoState = EGameFlowStateType::None;
+
+    //PendingGotoState re-enters the current state rather than being dropped as a no-op
+    bool IsPendingGotoForced = false;
+
+    //The next exit leaves telegraphs alone, set when a restore has just rebuilt them
+    bool KeepTelegraphsOnExit = false;
 
     UPROPERTY(Transient)
     TArray<FPendingEnemySpawn> PendingSpawns;
 
+    UPROPERTY(Transient)
+    UHexAnimationScheduler* AnimationScheduler;
+
     UPROPERTY(Transient)
     TArray<AMapEntity*> ActiveEnemies;
 
     UPROPERTY(Transient)
     TArray<AMapEntity*> ActiveFriendlies;
+
+    bool IsApplyingBoardCommands = false;
+
+    //Entities whose health changed in the current batch, in the order they first changed
+    UPROPERTY(Transient)
+    TArray<AMapEntity*> BatchedHealthEvents;
+
+    struct FPlannedAction
+    {
+        FHexMapCoord Move;
+        int AttackDirection;
+    };
+    TMap<const AMapEntity*, FPlannedAction> EnemyTurnPlan;
+
+    enum class EEnemyTurnStep : uint8
+    {
+        Move,
+        TelegraphAttack,
+        ResolveAttack
+    };
+
+    struct FEnemyTurnStep
+    {
+        TWeakObjectPtr<AMapEntity> Entity;
+        EEnemyTurnStep Step;
+    };
+    TArray<FEnemyTurnStep> EnemyTurnSteps;
+    int EnemyTurnStepIndex = 0;
+
+    //GotoNextFlowState was called while steps were queued, advance once they drain
+    bool AdvanceWhenEnemyTurnDrains = false;
+
+    //Telegraphed cells live in one pool, each record is a slice of it. Cleared together when attacks resolve
+    struct FTelegraphedAttack
+    {
+        TWeakObjectPtr<AMapEntity> Entity;
+        int FirstLocation;
+        int NumLocations;
+    };
+    TArray<FTelegraphedAttack> TelegraphedAttacks;
+    TArray<FHexMapCoord> TelegraphedLocations;
+
+    FGameplayEventQueue EventQueue;
+
+    FPresentationTimeline PresentationTimeline;
+
+    //GotoNextFlowState was called during playback, advance once it finishes
+    bool AdvanceWhenPresentationDrains = false;
+
+    FRandomStream RandomStream;
+
+    //Packed snapshots, oldest overwritten first. The buffers keep their allocations between turns
+    TArray<TArray<uint8>> UndoSnapshots;
+    int UndoHead = 0;
+    int NumUndoSnapshots = 0;
+
+    //Reused by every capture and restore
+    FGameStateSnapshot ScratchSnapshot;
+
+    TFuture<bool> PendingSave;
+
+    //Scratch for AI, attack and movement queries, lives for one game loop
+    FTurnArena TurnArena;
 };